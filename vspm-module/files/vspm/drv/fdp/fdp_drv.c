@@ -55,6 +55,10 @@
  * GNU General Public License for more details.
  */ /*************************************************************************/
 
+#include <linux/wait.h>
+#include <linux/pm_runtime.h>
+#include <linux/interrupt.h>
+
 #include "vspm_public.h"
 #include "vspm_ip_ctrl.h"
 #include "vspm_main.h"
@@ -85,6 +89,7 @@ long fdp_lib_init(struct fdp_obj_t **obj)
 
 	/* update status */
 	(*obj)->status = FDP_STAT_INIT;
+	init_waitqueue_head(&(*obj)->idle_wq);
 
 	return 0;
 }
@@ -172,6 +177,9 @@ long fdp_lib_open(struct fdp_obj_t *obj)
 	/* update status */
 	obj->status = FDP_STAT_READY;
 
+	/* device is suspended while no job is running */
+	fdp_ins_idle_clock(obj);
+
 	return 0;
 
 err_exit3:
@@ -190,7 +198,6 @@ err_exit1:
  * Returns:		0/E_FDP_INVALID_PARAM/E_FDP_INVALID_STATE
  *	return of fdp_free_inth()
  *	return of fdp_ins_quit_reg()
- *	return of fdp_ins_disable_clock()
  ******************************************************************************/
 long fdp_lib_close(struct fdp_obj_t *obj)
 {
@@ -214,11 +221,6 @@ long fdp_lib_close(struct fdp_obj_t *obj)
 	if (ercd)
 		return ercd;
 
-	/* disable clock */
-	ercd = fdp_ins_disable_clock(obj);
-	if (ercd)
-		return ercd;
-
 	/* update status */
 	obj->status = FDP_STAT_INIT;
 
@@ -230,6 +232,7 @@ long fdp_lib_close(struct fdp_obj_t *obj)
  * Description:	Start FDP processing
  * Returns:		0/E_FDP_INVALID_PARAM/E_FDP_INVALID_STATE
  *	return of fdp_ins_check_start_parameter()
+ *	return of fdp_ins_wake_clock()
  ******************************************************************************/
 long fdp_lib_start(struct fdp_obj_t *obj, struct fdp_start_t *start_par)
 {
@@ -251,6 +254,11 @@ long fdp_lib_start(struct fdp_obj_t *obj, struct fdp_start_t *start_par)
 	if (ercd)
 		return ercd;
 
+	/* wake up device */
+	ercd = fdp_ins_wake_clock(obj);
+	if (ercd)
+		return ercd;
+
 	/* update status */
 	obj->status = FDP_STAT_RUN;
 
@@ -260,6 +268,33 @@ long fdp_lib_start(struct fdp_obj_t *obj, struct fdp_start_t *start_par)
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		fdp_lib_request_abort
+ * Description:	Request abort of FDP processing without waiting.
+ *	fdp_lib_abort() waits for the stop, so the stop of several FDPs
+ *	progresses in parallel when it is requested to all of them first.
+ * Returns:		0/E_FDP_INVALID_PARAM
+ ******************************************************************************/
+long fdp_lib_request_abort(struct fdp_obj_t *obj)
+{
+	/* check parameter */
+	if (!obj)
+		return E_FDP_INVALID_PARAM;
+
+	/* check status */
+	if (obj->status != FDP_STAT_RUN)
+		return 0;
+
+	/* keep the device active even if the job ends now */
+	pm_runtime_get_noresume(&obj->pdev->dev);
+
+	fdp_ins_request_stop(obj);
+
+	fdp_ins_idle_clock(obj);
+
+	return 0;
+}
+
 /******************************************************************************
  * Function:		fdp_lib_abort
  * Description:	Abort FDP processing
@@ -271,13 +306,44 @@ long fdp_lib_abort(struct fdp_obj_t *obj)
 	if (!obj)
 		return E_FDP_INVALID_PARAM;
 
-	/* check status */
-	if (obj->status == FDP_STAT_RUN)
+	/* end the job, unless the interrupt thread has ended it */
+	if (fdp_ins_end_job(obj)) {
 		fdp_ins_stop_processing(obj);
 
+		/* release the device of the job */
+		fdp_ins_idle_clock(obj);
+	} else if (obj->irq) {
+		/* wait for the interrupt thread of the ended job */
+		synchronize_irq(obj->irq->start);
+	}
+
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		fdp_lib_recover
+ * Description:	Recover FDP from hang. The processing is stopped and
+ *	the hardware is reset.
+ * Returns:		0/E_FDP_INVALID_PARAM/E_FDP_INVALID_STATE
+ *	return of fdp_ins_reset_reg()
+ ******************************************************************************/
+long fdp_lib_recover(struct fdp_obj_t *obj)
+{
+	long ercd;
+
+	/* stop FDP processing */
+	ercd = fdp_lib_abort(obj);
+	if (ercd)
+		return ercd;
+
+	/* check status */
+	if (obj->status == FDP_STAT_INIT)
+		return E_FDP_INVALID_STATE;
+
+	/* reset hardware */
+	return fdp_ins_reset_reg(obj);
+}
+
 /******************************************************************************
  * Function:		fdp_lib_suspend
  * Description:	Suspend of FDP processing
@@ -316,6 +382,7 @@ long fdp_lib_suspend(struct fdp_obj_t *obj)
  * Function:		fdp_lib_resume
  * Description:	Resume of FDP processing
  * Returns:		0
+ *	return of fdp_ins_enable_clock().
  *	return of fdp_ins_init_reg().
  *	return of fdp_reg_inth().
  ******************************************************************************/
@@ -327,7 +394,12 @@ long fdp_lib_resume(struct fdp_obj_t *obj)
 	    !obj->fdp_reg) {
 		if (obj->status == FDP_STAT_READY) {
 			/* reinitialize register */
+			ercd = fdp_ins_enable_clock(obj);
+			if (ercd)
+				return ercd;
+
 			ercd = fdp_ins_init_reg(obj);
+			fdp_ins_idle_clock(obj);
 			if (ercd)
 				return ercd;
 
@@ -62,9 +62,12 @@
 #define P_FDP	(obj->fdp_reg)
 #define P_FCP	(obj->fcp_reg)
 
-/* define status read counter */
-#define FDP_STATUS_LOOP_TIME	(2)
-#define FDP_STATUS_LOOP_CNT		(500)
+/* define status read interval(usec) and counter of reset */
+#define FDP_STATUS_LOOP_TIME	(10)
+#define FDP_STATUS_LOOP_CNT		(100000)
+
+/* define timeout of waiting for the end of job(msec) */
+#define FDP_WAIT_TIMEOUT		(1000)
 
 /* define LUT table maximum size */
 #define FDP_LUT_TBL_MAX			(3)
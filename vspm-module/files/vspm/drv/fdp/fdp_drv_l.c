@@ -63,6 +63,8 @@
 #include <linux/delay.h>
 #include <linux/interrupt.h>
 #include <linux/pm_runtime.h>
+#include <linux/reset.h>
+#include <linux/atomic.h>
 
 #include "vspm_public.h"
 #include "vspm_ip_ctrl.h"
@@ -1176,15 +1178,37 @@ void fdp_ins_start_processing(
 }
 
 /******************************************************************************
- * Function:		fdp_ins_stop_processing
- * Description:	Abort FDP processing.
- * Returns:		void
+ * Function:		fdp_ins_wait_reset
+ * Description:	Wait for the end of reset. The reset completes in
+ *	microseconds without interrupt, so the status is polled at short
+ *	intervals.
+ * Returns:		remaining loop counter/On timeout is 0.
  ******************************************************************************/
-void fdp_ins_stop_processing(struct fdp_obj_t *obj)
+static unsigned int fdp_ins_wait_reset(
+	void __iomem *reg, unsigned int offset, unsigned int busy)
 {
-	unsigned int status;
-	unsigned int loop_cnt;
+	unsigned int loop_cnt = FDP_STATUS_LOOP_CNT;
 
+	while (fdp_read_reg(reg, offset) & busy) {
+		if (--loop_cnt == 0)
+			break;
+
+		/* sleep */
+		usleep_range(FDP_STATUS_LOOP_TIME, FDP_STATUS_LOOP_TIME * 2);
+	}
+
+	return loop_cnt;
+}
+
+/******************************************************************************
+ * Function:		fdp_ins_request_stop
+ * Description:	Request forced stop of FDP processing without waiting.
+ *	The reset of several FDPs progresses in parallel, and
+ *	fdp_ins_stop_processing() waits for it later.
+ * Returns:		void
+ ******************************************************************************/
+void fdp_ins_request_stop(struct fdp_obj_t *obj)
+{
 	/* disable interrupt */
 	fdp_write_reg(0, P_FDP, FD1_CTL_IRQENB);
 
@@ -1195,52 +1219,51 @@ void fdp_ins_stop_processing(struct fdp_obj_t *obj)
 	fdp_read_reg(P_FDP, FD1_CTL_IRQSTA);
 	fdp_read_reg(P_FDP, FD1_CTL_IRQSTA);
 
-	/* init loop counter */
-	loop_cnt = FDP_STATUS_LOOP_CNT;
-
-	/* read status register of FCP */
-	status = fdp_read_reg(P_FCP, FD1_FCP_STA);
-
-	if (status & FD1_FCP_STA_ACT) {
-		/* reset */
+	/* reset FCP, unless the requested reset completed */
+	if (fdp_read_reg(P_FCP, FD1_FCP_STA) & FD1_FCP_STA_ACT)
 		fdp_write_reg(FD1_FCP_RST_SOFTRST, P_FCP, FD1_FCP_RST);
+}
 
-		/* waiting reset process */
-		do {
-			/* sleep */
-			msleep(FDP_STATUS_LOOP_TIME);
+/******************************************************************************
+ * Function:		fdp_ins_end_job
+ * Description:	Change the status of the running job to ready. The
+ *	interrupt thread and the abort race for the end of the job, and only
+ *	the winner completes the job.
+ * Returns:		true: ended by the caller, false: not running
+ ******************************************************************************/
+bool fdp_ins_end_job(struct fdp_obj_t *obj)
+{
+	return cmpxchg(&obj->status, FDP_STAT_RUN, FDP_STAT_READY) ==
+		FDP_STAT_RUN;
+}
 
-			/* read status register of FCP */
-			status = fdp_read_reg(P_FCP, FD1_FCP_STA);
-		} while ((status & FD1_FCP_STA_ACT) &&
-			(--loop_cnt > 0));
+/******************************************************************************
+ * Function:		fdp_ins_stop_processing
+ * Description:	Abort FDP processing.
+ * Returns:		void
+ ******************************************************************************/
+void fdp_ins_stop_processing(struct fdp_obj_t *obj)
+{
+	unsigned int loop_cnt;
 
-		if (loop_cnt == 0) {
-			APRINT("%s: happen to timeout after reset of FCP!!\n",
-			       __func__);
-		}
-	}
+	/* request stop */
+	fdp_ins_request_stop(obj);
 
-	/* init loop counter */
-	loop_cnt = FDP_STATUS_LOOP_CNT;
+	/* waiting reset process of FCP */
+	loop_cnt = fdp_ins_wait_reset(P_FCP, FD1_FCP_STA, FD1_FCP_STA_ACT);
+	if (loop_cnt == 0) {
+		APRINT("%s: happen to timeout after reset of FCP!!\n",
+		       __func__);
+	}
 
 	/* read status register of FDP */
-	status = fdp_read_reg(P_FDP, FD1_CTL_STATUS);
-
-	if (status & FD1_CTL_STATUS_BSY) {
+	if (fdp_read_reg(P_FDP, FD1_CTL_STATUS) & FD1_CTL_STATUS_BSY) {
 		/* software reset */
 		fdp_write_reg(FD1_CTL_SRESET_SRST, P_FDP, FD1_CTL_SRESET);
 
 		/* waiting reset process */
-		do {
-			/* sleep */
-			msleep(FDP_STATUS_LOOP_TIME);
-
-			/* read status register of FDP */
-			status = fdp_read_reg(P_FDP, FD1_CTL_STATUS);
-		} while ((status & FD1_CTL_STATUS_BSY) &&
-			(--loop_cnt > 0));
-
+		loop_cnt = fdp_ins_wait_reset(
+			P_FDP, FD1_CTL_STATUS, FD1_CTL_STATUS_BSY);
 		if (loop_cnt == 0) {
 			APRINT("%s: happen to timeout after reset of FDP!!\n",
 			       __func__);
@@ -1252,37 +1275,46 @@ void fdp_ins_stop_processing(struct fdp_obj_t *obj)
 
 	/* update status */
 	obj->status = FDP_STAT_READY;
+
+	/* wait for the interrupt thread of the stopped job */
+	if (obj->irq)
+		synchronize_irq(obj->irq->start);
 }
 
 /******************************************************************************
  * Function:		fdp_ins_wait_processing
  * Description:	Waiting FDP processing.
+ *	The waiter is woken by the interrupt at the end of the job.
  * Returns:		void
  ******************************************************************************/
 void fdp_ins_wait_processing(struct fdp_obj_t *obj)
 {
-	unsigned int loop_cnt = FDP_STATUS_LOOP_CNT;
 	struct fdp_cb_info_t cb_info;
 
-	do {
-		/* sleep */
-		msleep(FDP_STATUS_LOOP_TIME);
-	} while ((obj->status == FDP_STAT_RUN) && (--loop_cnt > 0));
+	long ret;
 
-	if (loop_cnt == 0) {
+	ret = wait_event_timeout(
+		obj->idle_wq,
+		obj->status != FDP_STAT_RUN,
+		msecs_to_jiffies(FDP_WAIT_TIMEOUT));
+	if (ret == 0) {
 		APRINT("%s: happen to timeout!!\n", __func__);
 
 		/* save callback information */
 		cb_info = obj->cb_info;
 
 		/* update status */
-		obj->status = FDP_STAT_READY;
+		if (!fdp_ins_end_job(obj))
+			return;
 
 		/* execute callback2 */
 		if (cb_info.fdp_cb2) {
 			cb_info.fdp_cb2(
 				0, R_VSPM_DRIVER_ERR, cb_info.userdata2);
 		}
+
+		/* release the device of the job */
+		fdp_ins_idle_clock(obj);
 	}
 }
 
@@ -1344,14 +1376,21 @@ static void fdp_int_hdr(struct fdp_obj_t *obj)
 		/* save callback information */
 		cb_info = obj->cb_info;
 
-		/* update status */
-		obj->status = FDP_STAT_READY;
+		/* update status, unless the job is aborted */
+		if (!fdp_ins_end_job(obj))
+			return;
 
 		/* execute callback2 */
 		if (cb_info.fdp_cb2) {
 			cb_info.fdp_cb2(
 				0, R_VSPM_OK, cb_info.userdata2);
 		}
+
+		/* release the device of the job */
+		fdp_ins_idle_clock(obj);
+
+		/* wake up the waiter for the end of the job */
+		wake_up(&obj->idle_wq);
 	}
 }
 
@@ -1486,6 +1525,50 @@ static void fdp_ins_init_ipc_reg(struct fdp_obj_t *obj)
 		FD1_MDET_OFFSET);
 }
 
+/******************************************************************************
+ * Function:		fdp_ins_restore_reg
+ * Description:	Restore registers and look-up tables lost while the device
+ *	was suspended. They are kept when only the clocks were stopped.
+ * Returns:		void
+ ******************************************************************************/
+static void fdp_ins_restore_reg(struct fdp_obj_t *obj)
+{
+	/* check the register written at initialization */
+	if (fdp_read_reg(P_FDP, FD1_IPC_SMSK_THRESH) ==
+	    (FD1_IPC_SMSK_THRESH_FSM0 | FD1_IPC_SMSK_THRESH_SMSK_TH))
+		return;
+
+	fdp_ins_init_cmn_reg(obj);
+	fdp_ins_init_ipc_reg(obj);
+}
+
+/******************************************************************************
+ * Function:		fdp_ins_reset_reg
+ * Description:	Reset FDP/FCP after hang and initialize registers.
+ *	Software reset is used when the module reset is not defined.
+ * Returns:		0/E_FDP_NO_CLK
+ *	return of fdp_ins_wake_clock()
+ ******************************************************************************/
+long fdp_ins_reset_reg(struct fdp_obj_t *obj)
+{
+	long ercd;
+
+	ercd = fdp_ins_wake_clock(obj);
+	if (ercd)
+		return ercd;
+
+	/* module reset */
+	if (!obj->rstc || reset_control_reset(obj->rstc))
+		fdp_ins_software_reset(obj);
+
+	fdp_ins_init_cmn_reg(obj);
+	fdp_ins_init_ipc_reg(obj);
+
+	fdp_ins_idle_clock(obj);
+
+	return 0;
+}
+
 /******************************************************************************
  * Function:		fdp_ins_get_resource
  * Description:	Get FDP resource.
@@ -1580,8 +1663,9 @@ long fdp_ins_quit_reg(struct fdp_obj_t *obj)
 
 /******************************************************************************
  * Function:		fdp_ins_ih
- * Description:	Interrupt handler
- * Returns:		IRQ_HANDLED
+ * Description:	Interrupt handler. Acknowledge the interrupt and leave
+ *	the result collection to the interrupt thread.
+ * Returns:		IRQ_HANDLED/IRQ_WAKE_THREAD
  ******************************************************************************/
 static irqreturn_t fdp_ins_ih(int irq, void *dev)
 {
@@ -1589,6 +1673,10 @@ static irqreturn_t fdp_ins_ih(int irq, void *dev)
 
 	unsigned int status;
 
+	/* device may be suspended while no job is running */
+	if (obj->status != FDP_STAT_RUN)
+		return IRQ_HANDLED;
+
 	/* interrupt status read */
 	status = fdp_read_reg(P_FDP, FD1_CTL_IRQSTA);
 
@@ -1600,12 +1688,24 @@ static irqreturn_t fdp_ins_ih(int irq, void *dev)
 		/* clear interrupt status */
 		fdp_write_reg(0, P_FDP, FD1_CTL_IRQSTA);
 
-		fdp_int_hdr(obj);
+		return IRQ_WAKE_THREAD;
 	}
 
 	return IRQ_HANDLED;
 }
 
+/******************************************************************************
+ * Function:		fdp_ins_ih_thread
+ * Description:	Interrupt thread
+ * Returns:		IRQ_HANDLED
+ ******************************************************************************/
+static irqreturn_t fdp_ins_ih_thread(int irq, void *dev)
+{
+	fdp_int_hdr((struct fdp_obj_t *)dev);
+
+	return IRQ_HANDLED;
+}
+
 /******************************************************************************
  * Function:		fdp_reg_inth
  * Description:	Registry interrupt handler
@@ -1624,9 +1724,10 @@ long fdp_reg_inth(struct fdp_obj_t *obj)
 	}
 
 	/* registory interrupt handler */
-	ercd = request_irq(
+	ercd = request_threaded_irq(
 		obj->irq->start,
 		fdp_ins_ih,
+		fdp_ins_ih_thread,
 		IRQF_SHARED,
 		dev_name(&pdev->dev),
 		obj);
@@ -1693,6 +1794,47 @@ long fdp_ins_disable_clock(struct fdp_obj_t *obj)
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		fdp_ins_wake_clock
+ * Description:	Wake up FDP/FCP for a job.
+ * Returns:		0/E_FDP_NO_CLK
+ ******************************************************************************/
+long fdp_ins_wake_clock(struct fdp_obj_t *obj)
+{
+	struct device *dev = &obj->pdev->dev;
+
+	int ercd;
+
+	/* wake up device */
+	ercd = pm_runtime_get_sync(dev);
+	if (ercd < 0) {
+		EPRINT("%s: failed to pm_runtime_get_sync!! ercd=%d\n",
+		       __func__, ercd);
+		pm_runtime_put_noidle(dev);
+		return E_FDP_NO_CLK;
+	}
+
+	/* device was resumed */
+	if (ercd == 0)
+		fdp_ins_restore_reg(obj);
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		fdp_ins_idle_clock
+ * Description:	Mark FDP/FCP as idle. The device is suspended after
+ *	the autosuspend delay. This can be called from interrupt context.
+ * Returns:		void
+ ******************************************************************************/
+void fdp_ins_idle_clock(struct fdp_obj_t *obj)
+{
+	struct device *dev = &obj->pdev->dev;
+
+	pm_runtime_mark_last_busy(dev);
+	pm_runtime_put_autosuspend(dev);
+}
+
 /******************************************************************************
  * Function:		fdp_ins_allocate_memory
  * Description:	Allocate memory.
@@ -63,16 +63,21 @@ long fdp_ins_check_start_param(
 	struct fdp_obj_t *obj, struct fdp_start_t *start_par);
 void fdp_ins_start_processing(
 	struct fdp_obj_t *obj, struct fdp_start_t *start_par);
+void fdp_ins_request_stop(struct fdp_obj_t *obj);
+bool fdp_ins_end_job(struct fdp_obj_t *obj);
 void fdp_ins_stop_processing(struct fdp_obj_t *obj);
 void fdp_ins_wait_processing(struct fdp_obj_t *obj);
 
 long fdp_ins_get_resource(struct fdp_obj_t *obj);
 long fdp_ins_init_reg(struct fdp_obj_t *obj);
+long fdp_ins_reset_reg(struct fdp_obj_t *obj);
 long fdp_ins_quit_reg(struct fdp_obj_t *obj);
 long fdp_free_inth(struct fdp_obj_t *obj);
 long fdp_reg_inth(struct fdp_obj_t *obj);
 long fdp_ins_enable_clock(struct fdp_obj_t *obj);
 long fdp_ins_disable_clock(struct fdp_obj_t *obj);
+long fdp_ins_wake_clock(struct fdp_obj_t *obj);
+void fdp_ins_idle_clock(struct fdp_obj_t *obj);
 long fdp_ins_allocate_memory(struct fdp_obj_t **obj);
 long fdp_ins_release_memory(struct fdp_obj_t *obj);
 
@@ -69,6 +69,7 @@
 struct fdp_obj_t {
 	/* status information */
 	unsigned char status;
+	wait_queue_head_t idle_wq;	/* woken at the end of the job */
 
 	/* process information */
 	struct vspm_fdp_proc_info *proc_info;
@@ -96,6 +97,7 @@ struct fdp_obj_t {
 
 	/* platform information */
 	struct platform_device *pdev;
+	struct reset_control *rstc;
 	struct resource *irq;
 	void __iomem *fdp_reg;
 	void __iomem *fcp_reg;
@@ -107,7 +109,9 @@ long fdp_lib_quit(struct fdp_obj_t *obj);
 long fdp_lib_open(struct fdp_obj_t *obj);
 long fdp_lib_close(struct fdp_obj_t *obj);
 long fdp_lib_start(struct fdp_obj_t *obj, struct fdp_start_t *start_par);
+long fdp_lib_request_abort(struct fdp_obj_t *obj);
 long fdp_lib_abort(struct fdp_obj_t *obj);
+long fdp_lib_recover(struct fdp_obj_t *obj);
 long fdp_lib_suspend(struct fdp_obj_t *obj);
 long fdp_lib_resume(struct fdp_obj_t *obj);
 
@@ -57,6 +57,7 @@
 
 #include <linux/slab.h>
 #include <linux/sched.h>
+#include <linux/cache.h>
 
 #include "frame.h"
 
@@ -82,11 +83,12 @@ struct fw_msg_info {
 struct fw_task_info {
 	struct list_head list;
 	unsigned short tid;
+	/* written by every sender and the receiver */
 	struct {
 		struct list_head list;
 		spinlock_t lock;	/* protects the task message list */
 		wait_queue_head_t wait;
-	} msg;
+	} msg ____cacheline_aligned_in_smp;
 	struct completion suspend;
 };
 
@@ -97,7 +99,7 @@ struct fw_task_ctl {
 };
 
 /* task control table*/
-static struct fw_task_ctl task_ctl;
+static struct fw_task_ctl task_ctl ____cacheline_aligned_in_smp;
 
 /******************************************************************************
  * Function:		get_task_info
@@ -58,6 +58,11 @@
 #ifndef __VSPM_COMMON_H__
 #define __VSPM_COMMON_H__
 
+#include <linux/cache.h>
+#include <linux/timer.h>
+#include <linux/workqueue.h>
+#include <linux/ktime.h>
+
 /* Function ID of VSP manager */
 enum VSPM_FUNCTION_ID {
 	FUNC_VSPM_ENTRY = FUNC_TASK_RESUME + 1,
@@ -66,12 +71,31 @@ enum VSPM_FUNCTION_ID {
 	FUNC_VSPM_FORCED_CANCEL,
 	FUNC_VSPM_SET_MODE,
 	EVENT_VSPM_DISPATCH,
+	EVENT_VSPM_WATCHDOG,
+	EVENT_VSPM_RECOVERED,
+	FUNC_VSPM_CHECK_IDLE,
 	EVENT_VSPM_MAX
 };
 
 /* Max job */
 #define VSPM_MAX_ELEMENTS			32
 
+/* Max jobs merged into one VSP job */
+#define VSPM_MERGE_JOB_MAX			4
+
+/* Max jobs reordered for warm VSP state */
+#define VSPM_AFFINITY_WINDOW		4
+
+/* default and max expected processing time of a job(msec) */
+#define VSPM_WDT_DURATION			100
+#define VSPM_WDT_DURATION_MAX		60000
+
+/* a job is timed out after the expected time multiplied by margin */
+#define VSPM_WDT_MARGIN				4
+
+/* max retries of a job timed out */
+#define VSPM_WDT_RETRY_MAX			2
+
 /* job state */
 #define VSPM_JOB_STATUS_EMPTY		0
 #define VSPM_JOB_STATUS_ENTRY		1
@@ -93,14 +117,25 @@ enum VSPM_FUNCTION_ID {
 #define VSPM_CH_TO_BIT_INVERT(ch) \
 	(~VSPM_CH_TO_BIT(ch))
 
+/* extended members of VSP start parameter are set */
+#define VSPM_VSP_IS_EXT(vsp_par) \
+	((vsp_par)->ext_id == VSP_START_EXT_ID)
+
 /* job information structure */
 struct vspm_job_info {
 	unsigned long status;
 	unsigned long job_id;
 	unsigned long ch_num;
+	unsigned int exec_bits;		/* executing channel bits */
 	long result;
 	struct vspm_api_param_entry entry;
 	void *next_job_info;
+	void *merge_job_info;		/* jobs merged into this job */
+	unsigned int resume_part;	/* partition to resume */
+	unsigned char preempt;		/* preemption is requested */
+	unsigned char preemptible;	/* stop at every partition */
+	unsigned char bypass_cnt;	/* times bypassed by reordering */
+	unsigned char retry_cnt;	/* times retried after timeout */
 };
 
 /* job management structure */
@@ -116,10 +151,48 @@ struct vspm_queue_info {
 	void *first_job_info;
 };
 
+/* configuration of the previous VSP job */
+struct vspm_vsp_config {
+	unsigned char valid;
+	unsigned char rpf_num;
+	unsigned long use_module;
+	unsigned short src_format[5];
+	unsigned short dst_format;
+	unsigned short dst_width;
+	unsigned short dst_height;
+};
+
+/* watchdog of a channel */
+struct vspm_wdt_ch_info {
+	struct timer_list timer;
+	unsigned short module_id;
+	unsigned int seq;		/* sequence of the watched job */
+	ktime_t hang_time;			/* time of detecting hang */
+	struct vspm_job_info *job_info;	/* job held until recovered */
+};
+
+/* execution information of a channel */
+struct vspm_exec_ch_info {
+	struct vspm_job_info *job_info;		/* running job */
+	struct vspm_wdt_ch_info wdt;		/* watchdog of the job */
+	struct vspm_vsp_config vsp_config;	/* previous job of VSP */
+} ____cacheline_aligned_in_smp;
+
+/* watchdog information structure */
+struct vspm_wdt_info {
+	unsigned int recover_bits;	/* channels under recovery */
+	unsigned long reset_bits;	/* channels waiting for reset */
+	struct work_struct work;
+	struct vspm_recover_status_t status;
+};
+
 /* execution information structure */
 struct vspm_exec_info {
 	unsigned int exec_ch_bits;
-	struct vspm_job_info *p_exec_job_info[VSPM_CH_MAX];
+	/* each channel is on own cache line */
+	struct vspm_exec_ch_info ch_info[VSPM_CH_MAX];
+	/* recovery state and counters, touched by the reset work */
+	struct vspm_wdt_info wdt_info ____cacheline_aligned_in_smp;
 };
 
 /* VSP resource information structure */
@@ -137,12 +210,37 @@ struct vspm_usable_res_info {
 	struct vspm_usable_vsp_res_info vsp_res[VSPM_VSP_IP_MAX];
 };
 
+/* merged VSP job information structure */
+struct vspm_merge_info {
+	unsigned char job_num;
+	struct vspm_job_info *job_info[VSPM_MERGE_JOB_MAX];
+	struct vspm_job_t ip_par;
+	struct vsp_start_t st_par;
+	struct vsp_src_t src_par[VSPM_MERGE_JOB_MAX];
+	struct vsp_dst_t dst_par;
+	struct vsp_ctrl_t ctrl_par;
+	struct vsp_bru_t bru_par;
+	struct vsp_bld_vir_t vir_par;
+	struct vsp_bld_ctrl_t bld_par;
+};
+
 /* control information structure */
 struct vspm_ctrl_info {
-	struct vspm_job_manager job_manager;
+	/* queue of every dispatch, written by the VSPM thread */
 	struct vspm_queue_info queue_info;
-	struct vspm_exec_info exec_info;
-	struct vspm_usable_res_info usable_info;
+
+	/* running jobs, completion and recovery */
+	struct vspm_exec_info exec_info ____cacheline_aligned_in_smp;
+
+	/* job table */
+	struct vspm_job_manager job_manager ____cacheline_aligned_in_smp;
+
+	/* read from the caller context by estimation */
+	struct vspm_usable_res_info usable_info ____cacheline_aligned_in_smp;
+
+	/* work area of merged jobs */
+	struct vspm_merge_info merge_work ____cacheline_aligned_in_smp;
+	struct vspm_merge_info merge_info[VSPM_VSP_CH_NUM];
 };
 
 /* control functions */
@@ -158,6 +256,7 @@ long vspm_ins_ctrl_get_status(unsigned long job_id);
 long vspm_ins_ctrl_queue_cancel(unsigned long job_id);
 long vspm_ins_ctrl_forced_cancel(struct vspm_api_param_forced_cancel *cancel);
 long vspm_ins_ctrl_cancel_entry(struct vspm_privdata *priv);
+long vspm_ins_ctrl_check_idle(struct vspm_api_param_check_idle *idle);
 long vspm_ins_ctrl_mode_param_check(
 	unsigned int *use_bits, struct vspm_api_param_mode *mode);
 long vspm_ins_ctrl_entry_param_check(struct vspm_api_param_entry *entry);
@@ -168,8 +267,17 @@ long vspm_ins_ctrl_assign_channel(
 	unsigned short *ch);
 unsigned int vspm_ins_ctrl_get_usable_vsp_ch_bits(
 	struct vsp_start_t *vsp_par, struct vspm_usable_res_info *usable);
+long vspm_ins_ctrl_estimate(
+	struct vspm_request_res_info *request,
+	struct vsp_start_t *vsp_par,
+	struct vspm_estimate_t *estimate);
 void vspm_ins_ctrl_dispatch(void);
 void vspm_inc_ctrl_on_driver_complete(unsigned short module_id, long result);
+long vspm_ins_ctrl_on_watchdog(unsigned short module_id, unsigned int seq);
+long vspm_ins_ctrl_on_recovered(unsigned short module_id, long result);
+void vspm_inc_ctrl_on_watchdog(unsigned short module_id, unsigned int seq);
+void vspm_inc_ctrl_on_recovered(unsigned short module_id, long result);
+void vspm_ins_ctrl_get_recover_status(struct vspm_recover_status_t *status);
 
 /* job manager functions */
 struct vspm_job_info *vspm_ins_job_entry(
@@ -181,8 +289,14 @@ unsigned long vspm_ins_job_get_status(struct vspm_job_info *job_info);
 long vspm_ins_job_cancel(struct vspm_job_info *job_info);
 long vspm_ins_job_execute_start(
 	struct vspm_job_info *job_info, unsigned long exec_ch);
+long vspm_ins_job_execute_split(
+	struct vspm_job_info *job_info, unsigned long exec_ch);
+long vspm_ins_job_execute_merge(
+	struct vspm_job_info *job_info, struct vspm_job_info *merge_job_info);
 long vspm_ins_job_execute_complete(
 	struct vspm_job_info *job_info, long result, unsigned long comp_ch);
+long vspm_ins_job_execute_preempt(
+	struct vspm_job_info *job_info, unsigned int resume_part);
 void vspm_ins_job_remove(struct vspm_job_info *job_info);
 unsigned long vspm_ins_job_get_job_id(struct vspm_job_info *job_info);
 struct vspm_job_t *vspm_ins_job_get_ip_param(struct vspm_job_info *job_info);
@@ -194,20 +308,38 @@ long vspm_ins_exec_start(
 	struct vspm_exec_info *exec_info,
 	unsigned short module_id,
 	struct vspm_job_t *ip_par,
-	struct vspm_job_info *job_info);
+	struct vspm_job_info *job_info,
+	unsigned char split_idx,
+	unsigned char split_num);
 long vspm_ins_exec_complete(
 	struct vspm_exec_info *exec_info, unsigned short module_id);
 struct vspm_job_info *vspm_ins_exec_get_current_job_info(
 	struct vspm_exec_info *exec_info, unsigned short module_id);
 void vspm_ins_exec_update_current_status(
 	struct vspm_exec_info *exec_info, struct vspm_usable_res_info *usable);
+long vspm_ins_exec_request_cancel(
+	struct vspm_exec_info *exec_info, unsigned short module_id);
 long vspm_ins_exec_cancel(
 	struct vspm_exec_info *exec_info, unsigned short module_id);
+void vspm_ins_exec_init_watchdog(struct vspm_exec_info *exec_info);
+void vspm_ins_exec_quit_watchdog(struct vspm_exec_info *exec_info);
+long vspm_ins_exec_timeout(
+	struct vspm_exec_info *exec_info,
+	unsigned short module_id,
+	unsigned int seq);
+void vspm_ins_exec_recovered(
+	struct vspm_exec_info *exec_info, unsigned short module_id);
+struct vspm_job_info *vspm_ins_exec_get_held_job(
+	struct vspm_exec_info *exec_info, unsigned short module_id);
+struct vspm_job_info *vspm_ins_exec_release_job(
+	struct vspm_exec_info *exec_info, unsigned short module_id);
 
 /* sort queue functions */
 long vspm_inc_sort_queue_initialize(struct vspm_queue_info *queue_info);
 long vspm_inc_sort_queue_entry(
 	struct vspm_queue_info *queue_info, struct vspm_job_info *job_info);
+long vspm_inc_sort_queue_requeue(
+	struct vspm_queue_info *queue_info, struct vspm_job_info *job_info);
 long vspm_inc_sort_queue_refer(
 	struct vspm_queue_info *queue_info,
 	unsigned short index,
@@ -226,15 +358,47 @@ long vspm_ins_vsp_ch(unsigned short module_id, unsigned char *ch);
 long vspm_ins_vsp_initialize(
 	struct vspm_usable_res_info *usable, struct vspm_drvdata *pdrv);
 long vspm_ins_vsp_execute(
-	unsigned short module_id, struct vsp_start_t *vsp_par);
+	unsigned short module_id,
+	struct vsp_start_t *vsp_par,
+	unsigned char split_idx,
+	unsigned char split_num,
+	struct vspm_job_info *job_info);
 long vspm_ins_vsp_exec_complete(unsigned short module_id);
+long vspm_ins_vsp_preempt(unsigned short module_id);
+long vspm_ins_vsp_get_resume_part(
+	unsigned short module_id, unsigned int *resume_part);
+long vspm_ins_vsp_request_cancel(unsigned short module_id);
 long vspm_ins_vsp_cancel(unsigned short module_id);
+long vspm_ins_vsp_recover(unsigned short module_id);
 long vspm_ins_vsp_quit(struct vspm_usable_res_info *usable);
 long vspm_ins_vsp_execute_low_delay(
 	unsigned short module_id,
 	struct vspm_api_param_entry *entry);
 long vspm_ins_vsp_suspend(void);
 long vspm_ins_vsp_resume(void);
+unsigned int vspm_ins_vsp_get_resident_ch_bits(
+	struct vsp_start_t *vsp_par, unsigned int ch_bits);
+void vspm_ins_vsp_get_config(
+	struct vsp_start_t *vsp_par, struct vspm_vsp_config *config);
+unsigned int vspm_ins_vsp_get_affinity(
+	unsigned short module_id,
+	struct vspm_vsp_config *config,
+	struct vsp_start_t *vsp_par);
+long vspm_ins_vsp_estimate(
+	unsigned short module_id,
+	struct vsp_start_t *vsp_par,
+	struct vsp_estimate_t *estimate);
+void vspm_ins_vsp_estimate_split(
+	struct vsp_estimate_t *estimate, unsigned char split_num);
+unsigned char vspm_ins_vsp_get_split_num(
+	struct vsp_start_t *vsp_par, unsigned char max_num);
+unsigned char vspm_ins_vsp_get_merge_num(
+	struct vsp_start_t **vsp_par, unsigned char num);
+unsigned char vspm_ins_vsp_merge(
+	struct vspm_merge_info *merge,
+	struct vsp_start_t **vsp_par,
+	unsigned char num);
+void vspm_ins_vsp_link_merge(struct vspm_merge_info *merge);
 
 /* FDP control functions */
 long vspm_ins_fdp_ch(unsigned short module_id, unsigned char *ch);
@@ -245,7 +409,9 @@ long vspm_ins_fdp_execute(
 	struct fdp_start_t *fdp_par,
 	struct vspm_request_res_info *request);
 long vspm_ins_fdp_exec_complete(unsigned short module_id);
+long vspm_ins_fdp_request_cancel(unsigned short module_id);
 long vspm_ins_fdp_cancel(unsigned short module_id);
+long vspm_ins_fdp_recover(unsigned short module_id);
 long vspm_ins_fdp_quit(struct vspm_usable_res_info *usable);
 long vspm_ins_fdp_execute_low_delay(
 	unsigned short module_id,
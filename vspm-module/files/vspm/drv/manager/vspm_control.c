@@ -143,6 +143,24 @@ static unsigned short vspm_ins_ctrl_get_ch_msb(unsigned int bits)
 	return cnt;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_count_bits
+ * Description:	Get bit count of 1.
+ * Returns:		bit count
+ ******************************************************************************/
+static unsigned char vspm_ins_ctrl_count_bits(unsigned int bits)
+{
+	unsigned char cnt = 0;
+
+	bits &= 0xffff;
+	while (bits) {
+		bits &= (bits - 1);
+		cnt++;
+	}
+
+	return cnt;
+}
+
 /******************************************************************************
  * Function:		vspm_ins_ctrl_initialize
  * Description:	Initialize VSP Manager.
@@ -163,6 +181,9 @@ long vspm_ins_ctrl_initialize(struct vspm_drvdata *pdrv)
 	/* clear the VSPM driver control information table */
 	memset(&g_vspm_ctrl_info, 0, sizeof(g_vspm_ctrl_info));
 
+	/* initialize the watchdog of jobs */
+	vspm_ins_exec_init_watchdog(&g_vspm_ctrl_info.exec_info);
+
 	/* initialize the queue information table */
 	ercd = vspm_inc_sort_queue_initialize(&g_vspm_ctrl_info.queue_info);
 	if (ercd != R_VSPM_OK) {
@@ -201,6 +222,9 @@ long vspm_ins_ctrl_quit(struct vspm_drvdata *pdrv)
 	struct vspm_usable_res_info *usable = &g_vspm_ctrl_info.usable_info;
 	long ercd;
 
+	/* stop the watchdog and wait for the reset of IPs */
+	vspm_ins_exec_quit_watchdog(&g_vspm_ctrl_info.exec_info);
+
 	/* Finalize VSP driver */
 	ercd = vspm_ins_vsp_quit(usable);
 	if (ercd != R_VSPM_OK) {
@@ -226,6 +250,9 @@ long vspm_ins_ctrl_quit(struct vspm_drvdata *pdrv)
  ******************************************************************************/
 long vspm_ins_ctrl_suspend(struct vspm_drvdata *pdrv)
 {
+	/* stop the watchdog and wait for the reset of IPs */
+	vspm_ins_exec_quit_watchdog(&g_vspm_ctrl_info.exec_info);
+
 	/* suspend VSP driver */
 	(void)vspm_ins_vsp_suspend();
 
@@ -291,7 +318,20 @@ long vspm_ins_ctrl_set_mode(struct vspm_api_param_mode *mode)
 		request->mode = param->mode;
 
 		/* set process information */
+		request->affinity = 0;
+		request->bus_mode = VSP_BUS_DEFAULT;
+		request->watchdog = 0;
+		request->merge = 0;
 		switch (param->type) {
+		case VSPM_TYPE_VSP_AUTO:
+			if (param->par.vsp &&
+			    param->par.vsp->ext_id == VSPM_INIT_EXT_ID) {
+				request->affinity = param->par.vsp->affinity;
+				request->bus_mode = param->par.vsp->bus_mode;
+				request->watchdog = param->par.vsp->watchdog;
+				request->merge = param->par.vsp->merge;
+			}
+			break;
 		case VSPM_TYPE_FDP_AUTO:
 			memset(
 				&request->fdp_info,
@@ -303,6 +343,9 @@ long vspm_ins_ctrl_set_mode(struct vspm_api_param_mode *mode)
 				request->fdp_info.stlmsk_addr[1] =
 					param->par.fdp->hard_addr[1];
 			}
+			if (param->par.fdp &&
+			    param->par.fdp->ext_id == VSPM_INIT_EXT_ID)
+				request->watchdog = param->par.fdp->watchdog;
 			break;
 		default:
 			break;
@@ -388,12 +431,43 @@ long vspm_ins_ctrl_exec_entry(struct vspm_api_param_entry *entry)
 	return ercd;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_requeue_job
+ * Description:	Return the preempted job to the queue.
+ * Returns:		R_VSPM_OK
+ *	return of vspm_ins_vsp_get_resume_part()
+ *	return of vspm_ins_job_execute_preempt()
+ *	return of vspm_inc_sort_queue_requeue()
+ ******************************************************************************/
+static long vspm_ins_ctrl_requeue_job(
+	struct vspm_job_info *job_info, unsigned short module_id)
+{
+	unsigned int resume_part = 0;
+
+	long ercd;
+
+	/* Get the partition to resume */
+	ercd = vspm_ins_vsp_get_resume_part(module_id, &resume_part);
+	if (ercd)
+		return ercd;
+
+	/* Return the job to the entry state */
+	ercd = vspm_ins_job_execute_preempt(job_info, resume_part);
+	if (ercd)
+		return ercd;
+
+	/* Add the job ahead of the jobs of the same priority */
+	return vspm_inc_sort_queue_requeue(
+		&g_vspm_ctrl_info.queue_info, job_info);
+}
+
 /******************************************************************************
  * Function:		vspm_ins_ctrl_on_complete
  * Description:	Complete a job.
  * Returns:		R_VSPM_OK/R_VSPM_PARAERR
  *	return of vspm_ins_exec_complete()
  *	return of vspm_ins_job_execute_complete()
+ *	return of vspm_ins_ctrl_requeue_job()
 v******************************************************************************/
 long vspm_ins_ctrl_on_complete(unsigned short module_id, long result)
 {
@@ -428,6 +502,16 @@ long vspm_ins_ctrl_on_complete(unsigned short module_id, long result)
 		goto dispatch;
 	}
 
+	if (result == R_VSPM_PREEMPT) {
+		/* Return the preempted job to the queue */
+		ercd = vspm_ins_ctrl_requeue_job(job_info, module_id);
+		if (ercd == R_VSPM_OK)
+			goto dispatch;
+
+		EPRINT("failed to vspm_ins_ctrl_requeue_job %ld\n", ercd);
+		result = R_VSPM_NG;
+	}
+
 	/* Inform the completion of the job to the job management */
 	ercd = vspm_ins_job_execute_complete(job_info, result, module_id);
 	if (ercd) {
@@ -443,6 +527,134 @@ dispatch:
 	return ercd;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_retry_job
+ * Description:	Return the job timed out to the queue. The job is executed
+ *	again from the partition where it started, by the same IP after
+ *	the reset or by another usable IP.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ *	return of vspm_ins_job_execute_preempt()
+ *	return of vspm_inc_sort_queue_requeue()
+ ******************************************************************************/
+static long vspm_ins_ctrl_retry_job(
+	struct vspm_job_info *job_info, unsigned short module_id)
+{
+	long ercd;
+
+	/* FDP sequence and split or merged jobs cannot be rewound */
+	if (!IS_VSP_CH(module_id) ||
+	    job_info->exec_bits != VSPM_CH_TO_BIT(module_id) ||
+	    job_info->merge_job_info)
+		return R_VSPM_NG;
+
+	if (job_info->retry_cnt >= VSPM_WDT_RETRY_MAX)
+		return R_VSPM_NG;
+
+	/* Return the job to the entry state */
+	ercd = vspm_ins_job_execute_preempt(job_info, job_info->resume_part);
+	if (ercd)
+		return ercd;
+
+	job_info->retry_cnt++;
+
+	/* Add the job ahead of the jobs of the same priority */
+	return vspm_inc_sort_queue_requeue(
+		&g_vspm_ctrl_info.queue_info, job_info);
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_on_watchdog
+ * Description:	Timeout of a job. The IP is reset out of the VSPM thread,
+ *	and the job is held until vspm_ins_ctrl_on_recovered().
+ * Returns:		R_VSPM_OK
+ ******************************************************************************/
+long vspm_ins_ctrl_on_watchdog(unsigned short module_id, unsigned int seq)
+{
+	struct vspm_exec_info *exec_info = &g_vspm_ctrl_info.exec_info;
+	struct vspm_job_info *job_info;
+
+	long ercd;
+
+	/* Get job information of the job that is running */
+	job_info = vspm_ins_exec_get_current_job_info(exec_info, module_id);
+	if (!job_info)
+		return R_VSPM_OK;
+
+	if (vspm_ins_job_get_status(job_info) != VSPM_JOB_STATUS_EXECUTING)
+		return R_VSPM_OK;
+
+	/* Detach the job from the IP */
+	ercd = vspm_ins_exec_timeout(exec_info, module_id, seq);
+	if (ercd)
+		return R_VSPM_OK;
+
+	/* Execute the next job by the other IPs */
+	if (vspm_inc_sort_queue_get_count(&g_vspm_ctrl_info.queue_info) > 0)
+		vspm_ins_ctrl_dispatch();
+
+	return R_VSPM_OK;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_on_recovered
+ * Description:	Recovery of an IP is completed, and the job held since
+ *	the timeout is retried or completed with error. The job is not
+ *	retried and the IP is kept unusable when the reset failed.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_ctrl_on_recovered(unsigned short module_id, long result)
+{
+	struct vspm_exec_info *exec_info = &g_vspm_ctrl_info.exec_info;
+	struct vspm_recover_status_t *status = &exec_info->wdt_info.status;
+	struct vspm_job_info *job_info;
+
+	long ercd = R_VSPM_NG;
+
+	job_info = vspm_ins_exec_release_job(exec_info, module_id);
+
+	if (result) {
+		EPRINT("%s failed to recover module_id=0x%04x %ld\n",
+		       __func__, module_id, result);
+	} else {
+		vspm_ins_exec_recovered(exec_info, module_id);
+
+		/* Return the job to the queue */
+		if (job_info)
+			ercd = vspm_ins_ctrl_retry_job(job_info, module_id);
+	}
+
+	if (job_info) {
+		if (ercd == R_VSPM_OK) {
+			status->retry_num++;
+		} else {
+			/* Inform the error of the job */
+			status->error_num++;
+			ercd = vspm_ins_job_execute_complete(
+				job_info, R_VSPM_DRIVER_ERR, module_id);
+			if (ercd) {
+				EPRINT("%s failed to execute_complete %ld\n",
+				       __func__, ercd);
+			}
+		}
+	}
+
+	/* Execute the next job */
+	if (vspm_inc_sort_queue_get_count(&g_vspm_ctrl_info.queue_info) > 0)
+		vspm_ins_ctrl_dispatch();
+
+	return result ? R_VSPM_NG : R_VSPM_OK;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_get_recover_status
+ * Description:	Get statistics of recovery from IP hang.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_ins_ctrl_get_recover_status(struct vspm_recover_status_t *status)
+{
+	*status = g_vspm_ctrl_info.exec_info.wdt_info.status;
+}
+
 /******************************************************************************
  * Function:		vspm_ins_ctrl_get_status
  * Description:	Get status of entry jobs.
@@ -511,6 +723,82 @@ long vspm_ins_ctrl_queue_cancel(unsigned long job_id)
 	return rtncd;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_cancel_exec_job
+ * Description:	Cancel all channels executing the job.
+ * Returns:		R_VSPM_OK
+ *	return of vspm_ins_exec_cancel()
+ ******************************************************************************/
+static long vspm_ins_ctrl_cancel_exec_job(struct vspm_job_info *job_info)
+{
+	unsigned int exec_bits = job_info->exec_bits;
+	unsigned short module_id;
+
+	long ercd;
+
+	while (exec_bits) {
+		module_id = vspm_ins_ctrl_get_ch_lsb(exec_bits);
+		exec_bits &= VSPM_CH_TO_BIT_INVERT(module_id);
+
+		/* Release the job held until the reset of the IP */
+		if (vspm_ins_exec_get_held_job(
+				&g_vspm_ctrl_info.exec_info,
+				module_id) == job_info) {
+			(void)vspm_ins_exec_release_job(
+				&g_vspm_ctrl_info.exec_info, module_id);
+			(void)vspm_ins_job_execute_complete(
+				job_info, R_VSPM_CANCEL, module_id);
+			continue;
+		}
+
+		/* Cancel of executing IP */
+		ercd = vspm_ins_exec_cancel(
+			&g_vspm_ctrl_info.exec_info, module_id);
+		if (ercd) {
+			EPRINT("failed to vspm_ins_exec_cancel %ld\n", ercd);
+			return ercd;
+		}
+
+		/* Calcel the executing job */
+		(void)vspm_ins_job_execute_complete(
+			job_info, R_VSPM_CANCEL, module_id);
+	}
+
+	return R_VSPM_OK;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_request_cancel
+ * Description:	Request all IPs executing the jobs of the handle to stop.
+ *	The IPs stop in parallel, and the cancel of each job waits only
+ *	for the rest of the stop.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_ins_ctrl_request_cancel(struct vspm_privdata *priv)
+{
+	struct vspm_job_info *job_info;
+	unsigned int exec_bits = 0;
+	unsigned short module_id;
+	int i;
+
+	job_info = &g_vspm_ctrl_info.job_manager.job_info[0];
+	for (i = 0; i < VSPM_MAX_ELEMENTS; i++) {
+		if (job_info->entry.priv == priv &&
+		    job_info->status == VSPM_JOB_STATUS_EXECUTING)
+			exec_bits |= job_info->exec_bits;
+
+		job_info++;
+	}
+
+	while (exec_bits) {
+		module_id = vspm_ins_ctrl_get_ch_lsb(exec_bits);
+		exec_bits &= VSPM_CH_TO_BIT_INVERT(module_id);
+
+		(void)vspm_ins_exec_request_cancel(
+			&g_vspm_ctrl_info.exec_info, module_id);
+	}
+}
+
 /******************************************************************************
  * Function:		vspm_ins_ctrl_forced_cancel
  * Description:	Forced cancel a job.
@@ -524,6 +812,9 @@ long vspm_ins_ctrl_forced_cancel(struct vspm_api_param_forced_cancel *cancel)
 	long ercd;
 	int i;
 
+	/* Request the executing IPs to stop at once */
+	vspm_ins_ctrl_request_cancel(cancel->priv);
+
 	job_info = &g_vspm_ctrl_info.job_manager.job_info[0];
 	for (i = 0; i < VSPM_MAX_ELEMENTS; i++) {
 		if (job_info->entry.priv == cancel->priv &&
@@ -547,22 +838,10 @@ long vspm_ins_ctrl_forced_cancel(struct vspm_api_param_forced_cancel *cancel)
 				(void)vspm_ins_job_cancel(job_info);
 			} else if (job_info->status ==
 					VSPM_JOB_STATUS_EXECUTING) {
-				/* Cancel of executing IP */
-				ercd = vspm_ins_exec_cancel(
-					&g_vspm_ctrl_info.exec_info,
-					job_info->ch_num);
-				if (ercd) {
-					EPRINT(
-						"failed to vspm_ins_exec_cancel %ld\n",
-						ercd);
+				/* Cancel of executing IPs */
+				ercd = vspm_ins_ctrl_cancel_exec_job(job_info);
+				if (ercd)
 					return ercd;
-				}
-
-				/* Calcel the executing job */
-				(void)vspm_ins_job_execute_complete(
-					job_info,
-					R_VSPM_CANCEL,
-					job_info->ch_num);
 			}
 		}
 
@@ -603,6 +882,28 @@ long vspm_ins_ctrl_cancel_entry(struct vspm_privdata *priv)
 	return ercd;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_check_idle
+ * Description:	Check whether the handle has no queued or running job.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_ctrl_check_idle(struct vspm_api_param_check_idle *idle)
+{
+	struct vspm_job_info *job_info;
+	int i;
+
+	job_info = &g_vspm_ctrl_info.job_manager.job_info[0];
+	for (i = 0; i < VSPM_MAX_ELEMENTS; i++) {
+		if (job_info->entry.priv == idle->priv &&
+		    job_info->status != VSPM_JOB_STATUS_EMPTY)
+			return R_VSPM_NG;
+
+		job_info++;
+	}
+
+	return R_VSPM_OK;
+}
+
 /******************************************************************************
  * Function:		vspm_ins_ctrl_mode_param_check
  * Description:	Check operaton mode.
@@ -738,6 +1039,519 @@ long vspm_ins_ctrl_entry_param_check(struct vspm_api_param_entry *entry)
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_get_split_cand_bits
+ * Description:	Get VSP channels which the job can be split to, other than
+ *	the assigned channel.
+ * Returns:		channel bits/On not splittable is 0.
+ ******************************************************************************/
+static unsigned int vspm_ins_ctrl_get_split_cand_bits(
+	struct vsp_start_t *vsp_par,
+	struct vspm_request_res_info *request,
+	struct vspm_usable_res_info *usable,
+	unsigned short module_id,
+	unsigned int ch_bits)
+{
+	struct vsp_src_t *src_par;
+	struct vspm_usable_vsp_res_info *vsp_res;
+	struct vspm_usable_vsp_res_info *split_res;
+	unsigned int bits;
+	unsigned short ch_num;
+	unsigned char i;
+
+	if (request->mode != VSPM_MODE_MUTUAL)
+		return 0;
+
+	if (!VSPM_VSP_IS_EXT(vsp_par) || !(vsp_par->option & VSP_OPT_SPLIT))
+		return 0;
+
+	/* histogram, stripe and multi-pass jobs need all partitions */
+	if ((vsp_par->use_module & (VSP_HGO_USE | VSP_HGT_USE)) ||
+	    vsp_par->stripe_par || vsp_par->cascade_par ||
+	    vsp_par->fill_par || vsp_par->downscale_par ||
+	    vsp_par->damage_par)
+		return 0;
+
+	/* CLUT is rewritten in place for the RPF of each split */
+	for (i = 0; (i < vsp_par->rpf_num) && (i < 5); i++) {
+		src_par = vsp_par->src_par[i];
+		if (src_par &&
+		    (src_par->format == VSP_IN_RGB_CLUT_DATA ||
+		     src_par->format == VSP_IN_YUV_CLUT_DATA))
+			return 0;
+	}
+
+	/* except assigned channel */
+	ch_bits &= VSPM_CH_TO_BIT_INVERT(module_id);
+
+	/* splits share rpf_order, so RPFs must be assigned alike */
+	vsp_res = &usable->vsp_res[module_id - VSPM_VSP_CH_OFFSET];
+	bits = ch_bits;
+	while (bits) {
+		ch_num = vspm_ins_ctrl_get_ch_lsb(bits);
+		bits &= VSPM_CH_TO_BIT_INVERT(ch_num);
+
+		split_res = &usable->vsp_res[ch_num - VSPM_VSP_CH_OFFSET];
+		if (split_res->rpf_bits != vsp_res->rpf_bits ||
+		    split_res->rpf_clut_bits != vsp_res->rpf_clut_bits)
+			ch_bits &= VSPM_CH_TO_BIT_INVERT(ch_num);
+	}
+
+	return ch_bits;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_get_split_ch_bits
+ * Description:	Get idle VSP channels to split the job.
+ * Returns:		channel bits including the assigned channel
+ ******************************************************************************/
+static unsigned int vspm_ins_ctrl_get_split_ch_bits(
+	struct vspm_job_t *ip_par,
+	struct vspm_request_res_info *request,
+	struct vspm_usable_res_info *usable,
+	unsigned short module_id)
+{
+	struct vsp_start_t *vsp_par;
+	unsigned int split_bits = VSPM_CH_TO_BIT(module_id);
+	unsigned int idle_bits = request->ch_bits;
+	unsigned short ch_num;
+	unsigned char split_num;
+
+	if (ip_par->type != VSPM_TYPE_VSP_AUTO)
+		return split_bits;
+
+	vsp_par = ip_par->par.vsp;
+
+	/* except occupy and using channel */
+	idle_bits &= ~(usable->occupy_bits);
+	idle_bits &= usable->ch_bits;
+
+	/* shift channel bits */
+	idle_bits >>= VSPM_VSP_CH_OFFSET;
+	/* bit mask */
+	vspm_ins_mask_low_bits(&idle_bits, VSPM_VSP_CH_NUM);
+	/* update assigneble vsp channel bits */
+	idle_bits &= vspm_ins_ctrl_get_usable_vsp_ch_bits(vsp_par, usable);
+	idle_bits <<= VSPM_VSP_CH_OFFSET;
+
+	idle_bits = vspm_ins_ctrl_get_split_cand_bits(
+		vsp_par, request, usable, module_id, idle_bits);
+	if (idle_bits == 0)
+		return split_bits;
+
+	/* get number of split */
+	split_num = vspm_ins_vsp_get_split_num(
+		vsp_par, vspm_ins_ctrl_count_bits(idle_bits) + 1);
+
+	/* select channels from MSB */
+	while (split_num > 1) {
+		ch_num = vspm_ins_ctrl_get_ch_msb(idle_bits);
+		split_bits |= VSPM_CH_TO_BIT(ch_num);
+		idle_bits &= VSPM_CH_TO_BIT_INVERT(ch_num);
+		split_num--;
+	}
+
+	return split_bits;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_exec_split
+ * Description:	Execute the job split to several VSP channels.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_ins_ctrl_exec_split(
+	struct vspm_job_info *job_info,
+	struct vspm_job_t *ip_par,
+	unsigned short module_id,
+	unsigned int split_bits)
+{
+	unsigned int other_bits = split_bits & VSPM_CH_TO_BIT_INVERT(module_id);
+	unsigned short ch_num;
+	unsigned char split_num = vspm_ins_ctrl_count_bits(split_bits);
+	unsigned char split_idx;
+
+	long ercd;
+
+	/* Inform the split channels to the job management */
+	split_bits = other_bits;
+	while (split_bits) {
+		ch_num = vspm_ins_ctrl_get_ch_msb(split_bits);
+		split_bits &= VSPM_CH_TO_BIT_INVERT(ch_num);
+
+		(void)vspm_ins_job_execute_split(job_info, ch_num);
+	}
+
+	for (split_idx = 0; split_idx < split_num; split_idx++) {
+		if (split_idx == 0) {
+			/* 1st split on the assigned channel */
+			ch_num = module_id;
+		} else {
+			ch_num = vspm_ins_ctrl_get_ch_msb(other_bits);
+			other_bits &= VSPM_CH_TO_BIT_INVERT(ch_num);
+		}
+
+		/* Start the process */
+		ercd = vspm_ins_exec_start(
+			&g_vspm_ctrl_info.exec_info,
+			ch_num,
+			ip_par,
+			job_info,
+			split_idx,
+			split_num);
+		if (ercd) {
+			EPRINT("failed to vspm_ins_exec_start");
+			EPRINT("ercd=%ld, module_id=%d\n", ercd, ch_num);
+
+			/* Info the comp of the split to the job management */
+			(void)vspm_ins_job_execute_complete(
+				job_info, ercd, ch_num);
+		}
+	}
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_merge_job
+ * Description:	Merge the job and the following jobs of the same client
+ *	into one VSP job.
+ * Returns:		number of merged jobs(1: not merged)
+ ******************************************************************************/
+static unsigned char vspm_ins_ctrl_merge_job(
+	struct vspm_job_info *job_info,
+	unsigned short refer_index,
+	struct vspm_request_res_info *request,
+	struct vspm_usable_res_info *usable,
+	unsigned short *ch)
+{
+	struct vspm_merge_info *merge = &g_vspm_ctrl_info.merge_work;
+	struct vspm_job_info *merge_job_info[VSPM_MERGE_JOB_MAX];
+	struct vsp_start_t *vsp_par[VSPM_MERGE_JOB_MAX];
+	struct vspm_job_t *ip_par;
+	struct vsp_estimate_t estimate;
+
+	unsigned short queue_count;
+	unsigned short ch_num;
+	unsigned char num;
+	unsigned char i;
+
+	long ercd;
+
+	/* merging is requested by the client */
+	if (!request->merge)
+		return 1;
+
+	/* Get the number of entry */
+	queue_count = vspm_inc_sort_queue_get_count(
+		&g_vspm_ctrl_info.queue_info);
+
+	/* collect the following VSP jobs of the same client */
+	for (num = 0; num < VSPM_MERGE_JOB_MAX; num++) {
+		if (refer_index + num >= queue_count)
+			break;
+
+		ercd = vspm_inc_sort_queue_refer(
+			&g_vspm_ctrl_info.queue_info,
+			refer_index + num,
+			&merge_job_info[num]);
+		if (ercd)
+			break;
+
+		if (merge_job_info[num]->entry.priv != job_info->entry.priv)
+			break;
+
+		ip_par = vspm_ins_job_get_ip_param(merge_job_info[num]);
+		if (ip_par->type != VSPM_TYPE_VSP_AUTO)
+			break;
+
+		vsp_par[num] = ip_par->par.vsp;
+	}
+
+	if (num < 2)
+		return 1;
+
+	/* check the surface and the coverage of the jobs first */
+	num = vspm_ins_vsp_get_merge_num(vsp_par, num);
+	if (num < 2)
+		return 1;
+
+	/* build one composition of the jobs */
+	num = vspm_ins_vsp_merge(merge, vsp_par, num);
+	if (num < 2)
+		return 1;
+
+	/* assign channel having BRU and enough RPFs */
+	ercd = vspm_ins_ctrl_assign_channel(
+		&merge->ip_par, request, usable, &ch_num);
+	if (ercd)
+		return 1;
+
+	/* at last, check parameter and work memory for DL on the channel */
+	ercd = vspm_ins_vsp_estimate(ch_num, &merge->st_par, &estimate);
+	if (ercd || estimate.tbl_num > merge->st_par.dl_par.tbl_num)
+		return 1;
+
+	for (i = 0; i < num; i++)
+		merge->job_info[i] = merge_job_info[i];
+
+	*ch = ch_num;
+
+	return num;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_exec_merge
+ * Description:	Execute the merged VSP job.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_ins_ctrl_exec_merge(
+	unsigned short refer_index, unsigned short module_id)
+{
+	struct vspm_merge_info *merge =
+		&g_vspm_ctrl_info.merge_info[module_id - VSPM_VSP_CH_OFFSET];
+	struct vspm_job_info *job_info;
+
+	unsigned char i;
+	long ercd;
+
+	/* keep the parameter while the channel executes it */
+	*merge = g_vspm_ctrl_info.merge_work;
+	vspm_ins_vsp_link_merge(merge);
+
+	/* Remove the job informations from queue */
+	for (i = 0; i < merge->job_num; i++) {
+		(void)vspm_inc_sort_queue_remove(
+			&g_vspm_ctrl_info.queue_info, refer_index);
+	}
+
+	/* Inform the start of the jobs to the job management */
+	job_info = merge->job_info[0];
+	(void)vspm_ins_job_execute_start(job_info, module_id);
+	for (i = 1; i < merge->job_num; i++)
+		(void)vspm_ins_job_execute_merge(job_info, merge->job_info[i]);
+
+	/* Start the process */
+	ercd = vspm_ins_exec_start(
+		&g_vspm_ctrl_info.exec_info,
+		module_id,
+		&merge->ip_par,
+		job_info,
+		0,
+		1);
+	if (ercd) {
+		EPRINT("failed to vspm_ins_exec_start");
+		EPRINT("ercd=%ld, module_id=%d\n", ercd, module_id);
+
+		/* Info the comp of the jobs to the job management */
+		(void)vspm_ins_job_execute_complete(job_info, ercd, module_id);
+	}
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_get_affine_ch_bits
+ * Description:	Get VSP channel bits whose previous job is the most similar
+ *	to the job.
+ * Returns:		channel bits.
+ ******************************************************************************/
+static unsigned int vspm_ins_ctrl_get_affine_ch_bits(
+	struct vsp_start_t *vsp_par, unsigned int ch_bits)
+{
+	unsigned int affine_bits = 0;
+	unsigned int max_score = 0;
+	unsigned int score;
+
+	unsigned short ch;
+
+	for (ch = 0; ch < VSPM_VSP_CH_NUM; ch++) {
+		if (!(ch_bits & VSPM_CH_TO_BIT(ch)))
+			continue;
+
+		score = vspm_ins_vsp_get_affinity(
+			ch + VSPM_VSP_CH_OFFSET,
+			&g_vspm_ctrl_info.exec_info.ch_info[
+				ch + VSPM_VSP_CH_OFFSET].vsp_config,
+			vsp_par);
+		if (score > max_score) {
+			max_score = score;
+			affine_bits = 0;
+		}
+
+		if (score == max_score)
+			affine_bits |= VSPM_CH_TO_BIT(ch);
+	}
+
+	return affine_bits;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_select_affine_job
+ * Description:	Select the job of the same priority which suits an idle
+ *	VSP channel best. Jobs bypassed VSPM_AFFINITY_WINDOW times are not
+ *	bypassed any more.
+ * Returns:		queue index of the selected job.
+ ******************************************************************************/
+static unsigned short vspm_ins_ctrl_select_affine_job(
+	unsigned short refer_index, struct vspm_usable_res_info *usable)
+{
+	struct vspm_job_info *first_job_info;
+	struct vspm_job_info *job_info;
+	struct vspm_job_t *ip_par;
+	struct vspm_request_res_info *request;
+
+	unsigned short select_index = refer_index;
+	unsigned short index;
+	unsigned short ch;
+	unsigned int max_score = 0;
+	unsigned int score;
+	unsigned char found = 0;
+
+	long ercd;
+
+	ercd = vspm_inc_sort_queue_refer(
+		&g_vspm_ctrl_info.queue_info, refer_index, &first_job_info);
+	if (ercd)
+		return refer_index;
+
+	for (index = refer_index;
+	     index < refer_index + VSPM_AFFINITY_WINDOW; index++) {
+		ercd = vspm_inc_sort_queue_refer(
+			&g_vspm_ctrl_info.queue_info, index, &job_info);
+		if (ercd)
+			break;
+
+		/* reorder only the jobs of the same priority */
+		if (job_info->entry.job_priority !=
+				first_job_info->entry.job_priority)
+			break;
+
+		ip_par = vspm_ins_job_get_ip_param(job_info);
+		request = vspm_ins_job_get_request_param(job_info);
+		if (ip_par->type != VSPM_TYPE_VSP_AUTO || !request->affinity)
+			break;
+
+		/* score on the channel to be assigned */
+		ercd = vspm_ins_ctrl_assign_channel(
+			ip_par, request, usable, &ch);
+		if (!ercd) {
+			score = vspm_ins_vsp_get_affinity(
+				ch,
+				&g_vspm_ctrl_info.exec_info.ch_info[
+					ch].vsp_config,
+				ip_par->par.vsp);
+			if (!found || score > max_score) {
+				found = 1;
+				max_score = score;
+				select_index = index;
+			}
+		}
+
+		/* keep fairness */
+		if (job_info->bypass_cnt >= VSPM_AFFINITY_WINDOW)
+			break;
+	}
+
+	/* count bypassed jobs */
+	for (index = refer_index; index < select_index; index++) {
+		ercd = vspm_inc_sort_queue_refer(
+			&g_vspm_ctrl_info.queue_info, index, &job_info);
+		if (!ercd)
+			job_info->bypass_cnt++;
+	}
+
+	return select_index;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_is_urgent
+ * Description:	Check whether a job of the highest priority is waiting
+ *	in the queue or running on a VSP channel.
+ * Returns:		1: urgent job is active, 0: not active
+ ******************************************************************************/
+static unsigned char vspm_ins_ctrl_is_urgent(void)
+{
+	struct vspm_job_info *job_info;
+
+	int i;
+	long ercd;
+
+	/* the queue is sorted by priority */
+	ercd = vspm_inc_sort_queue_refer(
+		&g_vspm_ctrl_info.queue_info, 0, &job_info);
+	if (!ercd && job_info->entry.job_priority >= VSPM_PRI_MAX)
+		return 1;
+
+	for (i = 0; i < VSPM_VSP_CH_NUM; i++) {
+		job_info = vspm_ins_exec_get_current_job_info(
+			&g_vspm_ctrl_info.exec_info, i + VSPM_VSP_CH_OFFSET);
+		if (job_info && job_info->entry.job_priority >= VSPM_PRI_MAX)
+			return 1;
+	}
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_preempt_job
+ * Description:	Request to preempt a running job of lower priority on
+ *	a channel which can execute the job.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_ins_ctrl_preempt_job(
+	struct vspm_job_t *ip_par, struct vspm_request_res_info *request)
+{
+	struct vspm_job_info *exec_job_info;
+
+	unsigned int preempt_bits = request->ch_bits;
+	unsigned short module_id;
+	int i;
+
+	if (ip_par->type != VSPM_TYPE_VSP_AUTO)
+		return;
+
+	/* preempt one job at a time */
+	for (i = 0; i < VSPM_VSP_CH_NUM; i++) {
+		exec_job_info = vspm_ins_exec_get_current_job_info(
+			&g_vspm_ctrl_info.exec_info, i + VSPM_VSP_CH_OFFSET);
+		if (exec_job_info && exec_job_info->preempt)
+			return;
+	}
+
+	/* except occupy channel */
+	if (request->mode == VSPM_MODE_MUTUAL)
+		preempt_bits &= ~(g_vspm_ctrl_info.usable_info.occupy_bits);
+
+	/* shift channel bits */
+	preempt_bits >>= VSPM_VSP_CH_OFFSET;
+	/* bit mask */
+	vspm_ins_mask_low_bits(&preempt_bits, VSPM_VSP_CH_NUM);
+	/* channels which can execute the job */
+	preempt_bits &= vspm_ins_ctrl_get_usable_vsp_ch_bits(
+		ip_par->par.vsp, &g_vspm_ctrl_info.usable_info);
+
+	while (preempt_bits) {
+		/* get channel from MSB */
+		module_id = vspm_ins_ctrl_get_ch_msb(preempt_bits);
+		preempt_bits &= VSPM_CH_TO_BIT_INVERT(module_id);
+		module_id += VSPM_VSP_CH_OFFSET;
+
+		exec_job_info = vspm_ins_exec_get_current_job_info(
+			&g_vspm_ctrl_info.exec_info, module_id);
+		if (!exec_job_info)
+			continue;
+
+		if (exec_job_info->entry.job_priority >= VSPM_PRI_MAX)
+			continue;
+
+		/* split and merged jobs are not preempted */
+		if (exec_job_info->exec_bits != VSPM_CH_TO_BIT(module_id) ||
+		    exec_job_info->merge_job_info)
+			continue;
+
+		if (vspm_ins_vsp_preempt(module_id) == R_VSPM_OK) {
+			exec_job_info->preempt = 1;
+			return;
+		}
+	}
+}
+
 /******************************************************************************
  * Function:		vspm_ins_ctrl_dispatch
  * Description:	Execute the scheduling and processing.
@@ -749,6 +1563,7 @@ void vspm_ins_ctrl_dispatch(void)
 
 	unsigned short queue_count;
 	unsigned short refer_index = 0;
+	unsigned short index;
 
 	long ercd;
 
@@ -761,6 +1576,7 @@ void vspm_ins_ctrl_dispatch(void)
 		struct vspm_job_t *p_ip_par;
 		struct vspm_request_res_info *request;
 		unsigned short module_id;
+		unsigned int split_bits;
 
 		/* Set the channel available */
 		usable = g_vspm_ctrl_info.usable_info;
@@ -783,10 +1599,39 @@ void vspm_ins_ctrl_dispatch(void)
 		/* Get request parameter */
 		request = vspm_ins_job_get_request_param(job_info);
 
+		/* merge the following jobs to the same surface */
+		if (vspm_ins_ctrl_merge_job(
+				job_info, refer_index, request,
+				&usable, &module_id) > 1) {
+			vspm_ins_ctrl_exec_merge(refer_index, module_id);
+
+			/* Get the number of entry */
+			queue_count = vspm_inc_sort_queue_get_count(
+				&g_vspm_ctrl_info.queue_info);
+			continue;
+		}
+
+		/* prefer the job suited to an idle channel */
+		index = refer_index;
+		if (p_ip_par->type == VSPM_TYPE_VSP_AUTO && request->affinity)
+			index = vspm_ins_ctrl_select_affine_job(
+				refer_index, &usable);
+
+		if (index != refer_index) {
+			(void)vspm_inc_sort_queue_refer(
+				&g_vspm_ctrl_info.queue_info, index, &job_info);
+			p_ip_par = vspm_ins_job_get_ip_param(job_info);
+			request = vspm_ins_job_get_request_param(job_info);
+		}
+
 		/* assign channel */
 		ercd = vspm_ins_ctrl_assign_channel(
 			p_ip_par, request, &usable, &module_id);
 		if (ercd) {
+			/* preempt a lower priority job for urgent job */
+			if (job_info->entry.job_priority == VSPM_PRI_MAX)
+				vspm_ins_ctrl_preempt_job(p_ip_par, request);
+
 			/* not assigned */
 			refer_index++;
 			continue;
@@ -794,7 +1639,7 @@ void vspm_ins_ctrl_dispatch(void)
 
 		/* Remove a job information from queue */
 		(void)vspm_inc_sort_queue_remove(
-			&g_vspm_ctrl_info.queue_info, refer_index);
+			&g_vspm_ctrl_info.queue_info, index);
 
 		/* Get the number of entry */
 		queue_count = vspm_inc_sort_queue_get_count(
@@ -803,12 +1648,26 @@ void vspm_ins_ctrl_dispatch(void)
 		/* Inform the start of the job to the job management */
 		(void)vspm_ins_job_execute_start(job_info, module_id);
 
+		/* split the job to idle channels */
+		split_bits = vspm_ins_ctrl_get_split_ch_bits(
+			p_ip_par, request, &usable, module_id);
+		if (split_bits != VSPM_CH_TO_BIT(module_id)) {
+			vspm_ins_ctrl_exec_split(
+				job_info, p_ip_par, module_id, split_bits);
+			continue;
+		}
+
+		/* arm the preemption only while urgent jobs are active */
+		job_info->preemptible = vspm_ins_ctrl_is_urgent();
+
 		/* Start the process */
 		ercd = vspm_ins_exec_start(
 			&g_vspm_ctrl_info.exec_info,
 			module_id,
 			p_ip_par,
-			job_info);
+			job_info,
+			0,
+			1);
 		if (ercd) {
 			EPRINT("failed to vspm_ins_exec_start");
 			EPRINT("ercd=%ld, module_id=%d\n", ercd, module_id);
@@ -855,6 +1714,15 @@ long vspm_ins_ctrl_assign_channel(
 		/* update assigneble vsp channel bits */
 		assign_bits &= vspm_ins_ctrl_get_usable_vsp_ch_bits(
 			ip_par->par.vsp, usable);
+		if (request->affinity) {
+			/* prefer channel of the most similar job */
+			assign_bits = vspm_ins_ctrl_get_affine_ch_bits(
+				ip_par->par.vsp, assign_bits);
+		} else {
+			/* prefer channel holding the tables of the job */
+			assign_bits = vspm_ins_vsp_get_resident_ch_bits(
+				ip_par->par.vsp, assign_bits);
+		}
 		/* get channel from MSB */
 		ch_num = vspm_ins_ctrl_get_ch_msb(assign_bits);
 		ch_num += VSPM_VSP_CH_OFFSET;
@@ -879,24 +1747,6 @@ long vspm_ins_ctrl_assign_channel(
 	return R_VSPM_OK;
 }
 
-/******************************************************************************
- * Function:		vspm_ins_ctrl_count_bits
- * Description:	Get bit count of 1.
- * Returns:		bit count
- ******************************************************************************/
-static unsigned char vspm_ins_ctrl_count_bits(unsigned int bits)
-{
-	unsigned char cnt = 0;
-
-	bits &= 0xffff;
-	while (bits) {
-		bits &= (bits - 1);
-		cnt++;
-	}
-
-	return cnt;
-}
-
 /******************************************************************************
  * Function:		vspm_ins_ctrl_get_req_clut_count
  * Description:	Get request clut count of RPF.
@@ -970,6 +1820,11 @@ unsigned int vspm_ins_ctrl_get_usable_vsp_ch_bits(
 				vsp_par->use_module) != vsp_par->use_module)
 			assign_flag = 0;
 
+		/* check BRU module of cascade composition */
+		if (VSPM_VSP_IS_EXT(vsp_par) && vsp_par->cascade_par &&
+		    !(vsp_res->module_bits & VSP_BRU_USE))
+			assign_flag = 0;
+
 		ch_bits <<= 1;
 		if (assign_flag) {
 			/* set assignable bits */
@@ -982,6 +1837,64 @@ unsigned int vspm_ins_ctrl_get_usable_vsp_ch_bits(
 	return ch_bits;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_ctrl_estimate
+ * Description:	Estimate the cost of VSP job.
+ * Returns:		R_VSPM_OK/R_VSPM_PARAERR
+ *	return of vspm_ins_vsp_estimate()
+ ******************************************************************************/
+long vspm_ins_ctrl_estimate(
+	struct vspm_request_res_info *request,
+	struct vsp_start_t *vsp_par,
+	struct vspm_estimate_t *estimate)
+{
+	unsigned int assign_bits = request->ch_bits;
+	unsigned int split_bits;
+	unsigned short ch_num;
+
+	long ercd;
+
+	/* shift channel bits */
+	assign_bits >>= VSPM_VSP_CH_OFFSET;
+	/* bit mask */
+	vspm_ins_mask_low_bits(&assign_bits, VSPM_VSP_CH_NUM);
+	/* update assigneble vsp channel bits */
+	assign_bits &= vspm_ins_ctrl_get_usable_vsp_ch_bits(
+		vsp_par, &g_vspm_ctrl_info.usable_info);
+
+	/* get channel from MSB */
+	ch_num = vspm_ins_ctrl_get_ch_msb(assign_bits);
+	if (ch_num >= VSPM_VSP_CH_NUM) {
+		EPRINT("%s can't assign IP!! 0x%08x\n",
+		       __func__, request->ch_bits);
+		return R_VSPM_PARAERR;
+	}
+	ch_num += VSPM_VSP_CH_OFFSET;
+
+	/* estimate on the channel selected by dispatcher */
+	ercd = vspm_ins_vsp_estimate(ch_num, vsp_par, estimate->vsp);
+	if (ercd)
+		return ercd;
+
+	/* display list of the most split, each has own 1st partition */
+	split_bits = vspm_ins_ctrl_get_split_cand_bits(
+		vsp_par,
+		request,
+		&g_vspm_ctrl_info.usable_info,
+		ch_num,
+		assign_bits << VSPM_VSP_CH_OFFSET);
+	if (split_bits) {
+		vspm_ins_vsp_estimate_split(
+			estimate->vsp,
+			vspm_ins_ctrl_count_bits(split_bits) + 1);
+	}
+
+	/* set assignable channel bits */
+	estimate->use_ch = assign_bits;
+
+	return R_VSPM_OK;
+}
+
 /******************************************************************************
  * Function:		vspm_inc_ctrl_on_driver_complete
  * Description:	Complete processing.
@@ -1001,3 +1914,41 @@ void vspm_inc_ctrl_on_driver_complete(unsigned short module_id, long result)
 		&api_param);
 }
 
+/******************************************************************************
+ * Function:		vspm_inc_ctrl_on_watchdog
+ * Description:	Timeout of the watchdog.
+ *	This can be called from interrupt context.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_inc_ctrl_on_watchdog(unsigned short module_id, unsigned int seq)
+{
+	struct vspm_api_param_on_watchdog api_param;
+
+	api_param.module_id = module_id;
+	api_param.seq = seq;
+
+	(void)fw_send_event(
+		TASK_VSPM,
+		FUNCTIONID_VSPM_BASE + EVENT_VSPM_WATCHDOG,
+		sizeof(api_param),
+		&api_param);
+}
+
+/******************************************************************************
+ * Function:		vspm_inc_ctrl_on_recovered
+ * Description:	Recovery processing.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_inc_ctrl_on_recovered(unsigned short module_id, long result)
+{
+	struct vspm_api_param_on_complete api_param;
+
+	api_param.module_id = module_id;
+	api_param.result = result;
+
+	(void)fw_send_event(
+		TASK_VSPM,
+		FUNCTIONID_VSPM_BASE + EVENT_VSPM_RECOVERED,
+		sizeof(api_param),
+		&api_param);
+}
@@ -127,6 +127,7 @@ long vspm_ins_fdp_initialize(
 
 			/* set platform device information */
 			g_fdp_obj[ch]->pdev = pdrv->fdp_pdev[ch];
+			g_fdp_obj[ch]->rstc = pdrv->fdp_rstc[ch];
 
 			/* open the FDP driver */
 			ercd = fdp_lib_open(g_fdp_obj[ch]);
@@ -222,6 +223,32 @@ long vspm_ins_fdp_exec_complete(unsigned short module_id)
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_fdp_request_cancel
+ * Description:	Request to cancel FDP driver without waiting.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_fdp_request_cancel(unsigned short module_id)
+{
+	struct fdp_obj_t *obj;
+	unsigned char ch = 0;
+
+	long ercd;
+
+	/* convert module ID to channel */
+	ercd = vspm_ins_fdp_ch(module_id, &ch);
+	if (ercd)
+		return R_VSPM_NG;
+	obj = g_fdp_obj[ch];
+
+	/* request to abort process */
+	ercd = fdp_lib_request_abort(obj);
+	if (ercd)
+		return R_VSPM_NG;
+
+	return R_VSPM_OK;
+}
+
 /******************************************************************************
  * Function:		vspm_ins_fdp_cancel
  * Description:	Cancel FDP driver.
@@ -248,6 +275,35 @@ long vspm_ins_fdp_cancel(unsigned short module_id)
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_fdp_recover
+ * Description:	Recover FDP driver from hang.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_fdp_recover(unsigned short module_id)
+{
+	struct fdp_obj_t *obj;
+	unsigned char ch = 0;
+
+	long ercd;
+
+	/* convert module ID to channel */
+	ercd = vspm_ins_fdp_ch(module_id, &ch);
+	if (ercd)
+		return R_VSPM_NG;
+	obj = g_fdp_obj[ch];
+
+	/* stop process and reset hardware */
+	ercd = fdp_lib_recover(obj);
+	if (ercd) {
+		EPRINT("%s: failed to recover!! (%d, %ld)\n",
+		       __func__, ch, ercd);
+		return R_VSPM_NG;
+	}
+
+	return R_VSPM_OK;
+}
+
 /******************************************************************************
  * Function:		vspm_ins_fdp_quit
  * Description:	Finalize FDP driver.
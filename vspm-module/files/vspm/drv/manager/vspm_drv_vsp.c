@@ -55,6 +55,7 @@
  * GNU General Public License for more details.
  */ /*************************************************************************/
 
+#include <linux/kernel.h>
 #include <linux/string.h>
 
 #include "frame.h"
@@ -173,7 +174,17 @@ static long vspm_ins_assign_rpf(
 
 		/* searching bit of RPF supported CLUT */
 		if (use_rpf_clut_flag) {
-			bit = clut_bits & -clut_bits;
+			bit = 0;
+			if (!use_rpf_flag && VSPM_VSP_IS_EXT(start_param) &&
+			    (start_param->option & VSP_OPT_TBL_RESIDENT)) {
+				/* prefer RPF which the CLUT is loaded to */
+				bit = vsp_lib_get_resident_clut_bits(
+					ch, (*src_par)->clut);
+				bit &= clut_bits;
+				bit &= -bit;
+			}
+			if (bit == 0)
+				bit = clut_bits & -clut_bits;
 			if (bit != 0) {
 				rpf_order |= vspm_ins_get_bit_count(bit)
 					<< (num * 4);
@@ -194,6 +205,123 @@ static long vspm_ins_assign_rpf(
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_vsp_get_resident_ch_bits
+ * Description:	Get VSP channel bits holding the most tables of the job.
+ * Returns:		channel bits.
+ ******************************************************************************/
+unsigned int vspm_ins_vsp_get_resident_ch_bits(
+	struct vsp_start_t *vsp_par, unsigned int ch_bits)
+{
+	unsigned int resident_bits = 0;
+	unsigned int max_cnt = 0;
+	unsigned int cnt;
+
+	unsigned char ch;
+
+	for (ch = 0; ch < VSPM_VSP_IP_MAX; ch++) {
+		if (!(ch_bits & VSPM_CH_TO_BIT(ch)))
+			continue;
+
+		/* get number of loaded tables */
+		cnt = vsp_lib_get_resident_tbl_num(ch, vsp_par);
+		if (cnt == 0)
+			continue;
+
+		if (cnt > max_cnt) {
+			max_cnt = cnt;
+			resident_bits = 0;
+		}
+
+		if (cnt == max_cnt)
+			resident_bits |= VSPM_CH_TO_BIT(ch);
+	}
+
+	/* no channel holds the tables */
+	if (!resident_bits)
+		return ch_bits;
+
+	return resident_bits;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_get_config
+ * Description:	Get configuration of VSP job compared with the next job.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_ins_vsp_get_config(
+	struct vsp_start_t *vsp_par, struct vspm_vsp_config *config)
+{
+	unsigned char i;
+
+	memset(config, 0, sizeof(struct vspm_vsp_config));
+
+	config->valid = 1;
+	config->rpf_num = vsp_par->rpf_num;
+	config->use_module = vsp_par->use_module;
+
+	for (i = 0; (i < vsp_par->rpf_num) && (i < 5); i++) {
+		if (vsp_par->src_par[i])
+			config->src_format[i] = vsp_par->src_par[i]->format;
+	}
+
+	if (vsp_par->dst_par) {
+		config->dst_format = vsp_par->dst_par->format;
+		config->dst_width = vsp_par->dst_par->width;
+		config->dst_height = vsp_par->dst_par->height;
+	}
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_get_affinity
+ * Description:	Get similarity of VSP job to the previous job of channel.
+ * Returns:		score of similarity.
+ ******************************************************************************/
+unsigned int vspm_ins_vsp_get_affinity(
+	unsigned short module_id,
+	struct vspm_vsp_config *config,
+	struct vsp_start_t *vsp_par)
+{
+	unsigned int score = 0;
+	unsigned char ch = 0;
+	unsigned char i;
+
+	/* convert module ID to channel */
+	if (vspm_ins_vsp_ch(module_id, &ch))
+		return 0;
+
+	/* loaded tables avoid upload */
+	score += vsp_lib_get_resident_tbl_num(ch, vsp_par) << 2;
+
+	if (!config->valid)
+		return score;
+
+	/* same routing of modules */
+	if (config->use_module == vsp_par->use_module)
+		score += 2;
+
+	/* same input formats */
+	if (config->rpf_num == vsp_par->rpf_num) {
+		for (i = 0; (i < vsp_par->rpf_num) && (i < 5); i++) {
+			if (vsp_par->src_par[i] &&
+			    config->src_format[i] ==
+					vsp_par->src_par[i]->format)
+				score++;
+		}
+	}
+
+	/* same output geometry */
+	if (vsp_par->dst_par) {
+		if (config->dst_format == vsp_par->dst_par->format)
+			score++;
+		if (config->dst_width == vsp_par->dst_par->width &&
+		    config->dst_height == vsp_par->dst_par->height)
+			score++;
+	}
+
+	return score;
+}
+
 /******************************************************************************
  * Function:		vspm_cb_vsp
  * Description:	Callback function.
@@ -240,6 +368,7 @@ long vspm_ins_vsp_initialize(
 		if (pdrv->vsp_pdev[ch]) {
 			/* set parameter */
 			open_param.pdev = pdrv->vsp_pdev[ch];
+			open_param.rstc = pdrv->vsp_rstc[ch];
 
 			/* open channel */
 			ercd = vsp_lib_open(ch, &open_param);
@@ -292,11 +421,18 @@ long vspm_ins_vsp_initialize(
  * Function:		vspm_ins_vsp_execute
  * Description:	Execute VSP driver.
  * Returns:		R_VSPM_OK/R_VSPM_NG
- *	return of vsp_lib_start()
+ *	return of vsp_lib_start_preempt()
  ******************************************************************************/
-long vspm_ins_vsp_execute(unsigned short module_id, struct vsp_start_t *vsp_par)
+long vspm_ins_vsp_execute(
+	unsigned short module_id,
+	struct vsp_start_t *vsp_par,
+	unsigned char split_idx,
+	unsigned char split_num,
+	struct vspm_job_info *job_info)
 {
+	struct vspm_request_res_info *request;
 	struct vsp_start_t *start_param;
+	unsigned int resume_part = VSP_PREEMPT_OFF;
 	unsigned char ch = 0;
 
 	long ercd;
@@ -313,18 +449,85 @@ long vspm_ins_vsp_execute(unsigned short module_id, struct vsp_start_t *vsp_par)
 	if (ercd)
 		return R_VSPM_NG;
 
+	/* stop at every partition only while urgent jobs are active, */
+	/* and resume the job preempted or retried from its partition */
+	if (job_info->entry.job_priority < VSPM_PRI_MAX &&
+	    (job_info->preemptible || job_info->resume_part))
+		resume_part = job_info->resume_part;
+
+	/* bus access mode of the session */
+	request = vspm_ins_job_get_request_param(job_info);
+	ercd = vsp_lib_set_bus_mode(ch, request->bus_mode);
+	if (ercd)
+		return R_VSPM_NG;
+
 	/* execute VSP process */
-	ercd = vsp_lib_start(
+	ercd = vsp_lib_start_preempt(
 		ch,
 		(void *)vspm_cb_vsp,
 		start_param,
-		(void *)(unsigned long)module_id);
+		(void *)(unsigned long)module_id,
+		split_idx,
+		split_num,
+		resume_part);
 	if (ercd)
 		return ercd;
 
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_vsp_preempt
+ * Description:	Request to preempt VSP processing.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_vsp_preempt(unsigned short module_id)
+{
+	unsigned char ch = 0;
+
+	long ercd;
+
+	/* convert module ID to channel */
+	ercd = vspm_ins_vsp_ch(module_id, &ch);
+	if (ercd)
+		return R_VSPM_NG;
+
+	/* stop at the next partition boundary */
+	ercd = vsp_lib_preempt(ch);
+	if (ercd)
+		return R_VSPM_NG;
+
+	return R_VSPM_OK;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_get_resume_part
+ * Description:	Get partition to resume preempted VSP processing.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_vsp_get_resume_part(
+	unsigned short module_id, unsigned int *resume_part)
+{
+	struct vsp_status_t status;
+	unsigned char ch = 0;
+
+	long ercd;
+
+	/* convert module ID to channel */
+	ercd = vspm_ins_vsp_ch(module_id, &ch);
+	if (ercd)
+		return R_VSPM_NG;
+
+	/* get status */
+	ercd = vsp_lib_get_status(ch, &status);
+	if (ercd)
+		return R_VSPM_NG;
+
+	*resume_part = status.resume_part;
+
+	return R_VSPM_OK;
+}
+
 /******************************************************************************
  * Function:		vspm_ins_vsp_exec_complete
  * Description:	Complete VSP driver.
@@ -335,6 +538,30 @@ long vspm_ins_vsp_exec_complete(unsigned short module_id)
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_vsp_request_cancel
+ * Description:	Request to cancel VSP driver without waiting.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_vsp_request_cancel(unsigned short module_id)
+{
+	unsigned char ch = 0;
+
+	long ercd;
+
+	/* convert module ID to channel */
+	ercd = vspm_ins_vsp_ch(module_id, &ch);
+	if (ercd)
+		return R_VSPM_NG;
+
+	/* request to abort process */
+	ercd = vsp_lib_request_abort(ch);
+	if (ercd)
+		return R_VSPM_NG;
+
+	return R_VSPM_OK;
+}
+
 /******************************************************************************
  * Function:		vspm_ins_vsp_cancel
  * Description:	Cancel VSP driver.
@@ -362,6 +589,33 @@ long vspm_ins_vsp_cancel(unsigned short module_id)
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_vsp_recover
+ * Description:	Recover VSP driver from hang.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_vsp_recover(unsigned short module_id)
+{
+	unsigned char ch = 0;
+
+	long ercd;
+
+	/* convert module ID to channel */
+	ercd = vspm_ins_vsp_ch(module_id, &ch);
+	if (ercd)
+		return R_VSPM_NG;
+
+	/* stop process and reset hardware */
+	ercd = vsp_lib_recover(ch);
+	if (ercd) {
+		EPRINT("%s: failed to recover!! (%d, %ld)\n",
+		       __func__, ch, ercd);
+		return R_VSPM_NG;
+	}
+
+	return R_VSPM_OK;
+}
+
 /******************************************************************************
  * Function:		vspm_ins_vsp_quit
  * Description:	Finalize VSP driver.
@@ -428,6 +682,11 @@ long vspm_ins_vsp_execute_low_delay(
 	if (ercd)
 		return R_VSPM_NG;
 
+	/* bus access mode of the session */
+	ercd = vsp_lib_set_bus_mode(ch, entry->priv->request_info.bus_mode);
+	if (ercd)
+		return R_VSPM_NG;
+
 	/* execute VSP process */
 	ercd = vsp_lib_start(
 		ch,
@@ -483,3 +742,378 @@ long vspm_ins_vsp_resume(void)
 
 	return R_VSPM_OK;
 }
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_estimate
+ * Description:	Estimate VSP processing.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ *	return of vsp_lib_estimate()
+ ******************************************************************************/
+long vspm_ins_vsp_estimate(
+	unsigned short module_id,
+	struct vsp_start_t *vsp_par,
+	struct vsp_estimate_t *estimate)
+{
+	struct vsp_start_t start_param;
+	unsigned char ch = 0;
+
+	long ercd;
+
+	/* convert module ID to channel */
+	ercd = vspm_ins_vsp_ch(module_id, &ch);
+	if (ercd)
+		return R_VSPM_NG;
+
+	/* assign RPF channel to a copy of the parameter */
+	start_param = *vsp_par;
+	ercd = vspm_ins_assign_rpf(ch, &start_param);
+	if (ercd)
+		return R_VSPM_NG;
+
+	/* estimate VSP process */
+	ercd = vsp_lib_estimate(ch, &start_param, estimate);
+	if (ercd)
+		return ercd;
+
+	return R_VSPM_OK;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_estimate_split
+ * Description:	Update the estimate with display list of the split job.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_ins_vsp_estimate_split(
+	struct vsp_estimate_t *estimate, unsigned char split_num)
+{
+	estimate->tbl_num = (unsigned short)vsp_lib_get_split_tbl_num(
+		estimate->part_num, split_num);
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_get_split_num
+ * Description:	Get number of VSP channels to split the job.
+ * Returns:		number of split(1: not split)
+ ******************************************************************************/
+unsigned char vspm_ins_vsp_get_split_num(
+	struct vsp_start_t *vsp_par, unsigned char max_num)
+{
+	unsigned int min_part;
+	unsigned int max_part;
+	unsigned char split_num;
+
+	long ercd;
+
+	/* get number of partitions from the parameter */
+	ercd = vsp_lib_get_part_range(vsp_par, &min_part, &max_part);
+	if (ercd)
+		return 1;
+
+	/* limit by work memory for DL of the most partitions */
+	split_num = vsp_lib_get_split_num(
+		max_part, vsp_par->dl_par.tbl_num, max_num);
+
+	/* every split has at least one partition */
+	if (split_num > min_part)
+		split_num = (unsigned char)min_part;
+
+	return split_num;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_is_mergeable
+ * Description:	Check whether the job is a single layer copy to merge.
+ * Returns:		1: mergeable/0: not mergeable
+ ******************************************************************************/
+static int vspm_ins_vsp_is_mergeable(struct vsp_start_t *vsp_par)
+{
+	struct vsp_src_t *src_par = vsp_par->src_par[0];
+	struct vsp_dst_t *dst_par = vsp_par->dst_par;
+
+	/* RPF to WPF directly */
+	if (vsp_par->rpf_num != 1 || vsp_par->use_module != 0)
+		return 0;
+
+	/* no extended processing */
+	if (VSPM_VSP_IS_EXT(vsp_par) &&
+	    (vsp_par->stripe_par || vsp_par->cascade_par ||
+	     vsp_par->damage_par || vsp_par->fill_par ||
+	     vsp_par->downscale_par || vsp_par->hist_par))
+		return 0;
+
+	if (!src_par || !dst_par)
+		return 0;
+
+	if (src_par->connect != 0 || src_par->pwd != VSP_LAYER_PARENT)
+		return 0;
+
+	/* output the whole source image without clipping */
+	if (src_par->width_ex != 0 || src_par->height_ex != 0)
+		return 0;
+
+	if (dst_par->width != src_par->width ||
+	    dst_par->height != src_par->height)
+		return 0;
+
+	if (dst_par->x_coffset != 0 || dst_par->y_coffset != 0)
+		return 0;
+
+	if (dst_par->rotation != VSP_ROT_OFF || dst_par->fcp)
+		return 0;
+
+	return 1;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_is_same_surface
+ * Description:	Check whether the jobs output to the same surface.
+ * Returns:		1: same surface/0: other surface
+ ******************************************************************************/
+static int vspm_ins_vsp_is_same_surface(
+	struct vsp_dst_t *dst_par, struct vsp_dst_t *other_par)
+{
+	/* buffer */
+	if (dst_par->addr != other_par->addr ||
+	    dst_par->addr_c0 != other_par->addr_c0 ||
+	    dst_par->addr_c1 != other_par->addr_c1 ||
+	    dst_par->stride != other_par->stride ||
+	    dst_par->stride_c != other_par->stride_c)
+		return 0;
+
+	/* format and conversion */
+	if (dst_par->format != other_par->format ||
+	    dst_par->swap != other_par->swap ||
+	    dst_par->pxa != other_par->pxa ||
+	    dst_par->pad != other_par->pad ||
+	    dst_par->csc != other_par->csc ||
+	    dst_par->iturbt != other_par->iturbt ||
+	    dst_par->clrcng != other_par->clrcng ||
+	    dst_par->cbrm != other_par->cbrm ||
+	    dst_par->abrm != other_par->abrm ||
+	    dst_par->athres != other_par->athres ||
+	    dst_par->clmd != other_par->clmd ||
+	    dst_par->dith != other_par->dith)
+		return 0;
+
+	return 1;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_get_cover_area
+ * Description:	Get area covered by output rectangles of the jobs.
+ * Returns:		area of union of the rectangles.
+ ******************************************************************************/
+static long vspm_ins_vsp_get_cover_area(
+	struct vsp_start_t **vsp_par, unsigned char num)
+{
+	struct vsp_dst_t *dst_par;
+
+	long area = 0;
+	long left, top, right, bottom;
+	unsigned int mask;
+	unsigned char cnt;
+	unsigned char i;
+
+	/* inclusion-exclusion of intersections */
+	for (mask = 1; mask < (0x1U << num); mask++) {
+		left = 0;
+		top = 0;
+		right = LONG_MAX;
+		bottom = LONG_MAX;
+		cnt = 0;
+
+		for (i = 0; i < num; i++) {
+			if (!(mask & (0x1U << i)))
+				continue;
+
+			dst_par = vsp_par[i]->dst_par;
+			left = max_t(long, left, dst_par->x_offset);
+			top = max_t(long, top, dst_par->y_offset);
+			right = min_t(long, right,
+				      dst_par->x_offset + dst_par->width);
+			bottom = min_t(long, bottom,
+				       dst_par->y_offset + dst_par->height);
+			cnt++;
+		}
+
+		if (right <= left || bottom <= top)
+			continue;
+
+		if (cnt & 0x1)
+			area += (right - left) * (bottom - top);
+		else
+			area -= (right - left) * (bottom - top);
+	}
+
+	return area;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_link_merge
+ * Description:	Link parameters of the merged VSP job.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_ins_vsp_link_merge(struct vspm_merge_info *merge)
+{
+	struct vsp_bru_t *bru_par = &merge->bru_par;
+	unsigned char i;
+
+	merge->ip_par.type = VSPM_TYPE_VSP_AUTO;
+	merge->ip_par.par.vsp = &merge->st_par;
+
+	for (i = 0; i < merge->job_num; i++)
+		merge->st_par.src_par[i] = &merge->src_par[i];
+	merge->st_par.dst_par = &merge->dst_par;
+	merge->st_par.ctrl_par = &merge->ctrl_par;
+
+	merge->ctrl_par.bru = bru_par;
+
+	bru_par->blend_virtual = &merge->vir_par;
+	bru_par->blend_unit_a = &merge->bld_par;
+	if (merge->job_num > 1)
+		bru_par->blend_unit_c = &merge->bld_par;
+	if (merge->job_num > 2)
+		bru_par->blend_unit_d = &merge->bld_par;
+	if (merge->job_num > 3)
+		bru_par->blend_unit_e = &merge->bld_par;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_get_merge_num
+ * Description:	Count the leading jobs which are mergeable copies to the
+ *	same surface and fully cover their bounding rectangle.
+ * Returns:		number of mergeable jobs(1: not mergeable)
+ ******************************************************************************/
+unsigned char vspm_ins_vsp_get_merge_num(
+	struct vsp_start_t **vsp_par, unsigned char num)
+{
+	struct vsp_dst_t *dst_par;
+
+	long left, top, right, bottom;
+	unsigned char i;
+
+	if (num > VSPM_MERGE_JOB_MAX)
+		num = VSPM_MERGE_JOB_MAX;
+
+	/* count mergeable jobs */
+	for (i = 0; i < num; i++) {
+		if (!vspm_ins_vsp_is_mergeable(vsp_par[i]))
+			break;
+
+		if (!vspm_ins_vsp_is_same_surface(
+				vsp_par[0]->dst_par, vsp_par[i]->dst_par))
+			break;
+	}
+	num = i;
+
+	/* the virtual background must be hidden by the jobs, */
+	/* because WPF writes the whole bounding rectangle */
+	while (num > 1) {
+		left = LONG_MAX;
+		top = LONG_MAX;
+		right = 0;
+		bottom = 0;
+
+		for (i = 0; i < num; i++) {
+			dst_par = vsp_par[i]->dst_par;
+			left = min_t(long, left, dst_par->x_offset);
+			top = min_t(long, top, dst_par->y_offset);
+			right = max_t(long, right,
+				      dst_par->x_offset + dst_par->width);
+			bottom = max_t(long, bottom,
+				       dst_par->y_offset + dst_par->height);
+		}
+
+		if (vspm_ins_vsp_get_cover_area(vsp_par, num) ==
+				(right - left) * (bottom - top))
+			break;
+
+		num--;
+	}
+
+	return num ? num : 1;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_vsp_merge
+ * Description:	Merge single layer copies to the same surface into
+ *	one BRU composition over a virtual background.
+ *	The jobs must be checked by vspm_ins_vsp_get_merge_num().
+ * Returns:		number of merged jobs(1: not merged)
+ ******************************************************************************/
+unsigned char vspm_ins_vsp_merge(
+	struct vspm_merge_info *merge,
+	struct vsp_start_t **vsp_par,
+	unsigned char num)
+{
+	/* blend units from bottom to top */
+	static const unsigned char lay_shift[VSPM_MERGE_JOB_MAX] = {
+		4, 12, 16, 20	/* SRC_A, SRC_C, SRC_D, SRC_E */
+	};
+
+	struct vsp_dst_t *dst_par;
+
+	long left = LONG_MAX, top = LONG_MAX, right = 0, bottom = 0;
+	unsigned char i;
+
+	if (num <= 1 || num > VSPM_MERGE_JOB_MAX)
+		return 1;
+
+	/* bounding rectangle of the jobs */
+	for (i = 0; i < num; i++) {
+		dst_par = vsp_par[i]->dst_par;
+		left = min_t(long, left, dst_par->x_offset);
+		top = min_t(long, top, dst_par->y_offset);
+		right = max_t(long, right,
+			      dst_par->x_offset + dst_par->width);
+		bottom = max_t(long, bottom,
+			       dst_par->y_offset + dst_par->height);
+	}
+
+	memset(merge, 0, sizeof(*merge));
+	merge->job_num = num;
+
+	/* output the bounding rectangle */
+	merge->dst_par = *vsp_par[0]->dst_par;
+	merge->dst_par.x_offset = (unsigned short)left;
+	merge->dst_par.y_offset = (unsigned short)top;
+	merge->dst_par.width = (unsigned short)(right - left);
+	merge->dst_par.height = (unsigned short)(bottom - top);
+
+	/* virtual background defines the size of composition */
+	merge->vir_par.width = merge->dst_par.width;
+	merge->vir_par.height = merge->dst_par.height;
+	merge->vir_par.pwd = VSP_LAYER_PARENT;
+
+	/* upper layer replaces lower layers like a sequence of copies */
+	merge->bld_par.rbc = VSP_RBC_ROP;
+	merge->bld_par.crop = VSP_IROP_COPY;
+	merge->bld_par.arop = VSP_IROP_COPY;
+
+	merge->bru_par.lay_order = VSP_LAY_VIRTUAL;	/* DST_A */
+	merge->bru_par.adiv = VSP_DIVISION_OFF;
+	merge->bru_par.connect = 0;
+
+	for (i = 0; i < num; i++) {
+		dst_par = vsp_par[i]->dst_par;
+
+		merge->src_par[i] = *vsp_par[i]->src_par[0];
+		merge->src_par[i].pwd = VSP_LAYER_CHILD;
+		merge->src_par[i].x_position =
+			(unsigned short)(dst_par->x_offset - left);
+		merge->src_par[i].y_position =
+			(unsigned short)(dst_par->y_offset - top);
+		merge->src_par[i].connect = VSP_BRU_USE;
+
+		merge->bru_par.lay_order |=
+			((unsigned long)(VSP_LAY_1 + i)) << lay_shift[i];
+	}
+
+	merge->st_par.rpf_num = num;
+	merge->st_par.use_module = VSP_BRU_USE;
+	merge->st_par.dl_par = vsp_par[0]->dl_par;
+
+	vspm_ins_vsp_link_merge(merge);
+
+	return num;
+}
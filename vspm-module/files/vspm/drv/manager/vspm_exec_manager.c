@@ -56,6 +56,8 @@
  */ /*************************************************************************/
 
 #include <linux/string.h>
+#include <linux/jiffies.h>
+#include <linux/bitops.h>
 
 #include "frame.h"
 
@@ -67,6 +69,79 @@
 #include "vspm_lib_public.h"
 #include "vspm_common.h"
 
+/******************************************************************************
+ * Function:		vspm_ins_exec_start_watchdog
+ * Description:	Start the watchdog of the job.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_ins_exec_start_watchdog(
+	struct vspm_wdt_ch_info *ch_info, unsigned int duration)
+{
+	if (duration == 0)
+		duration = VSPM_WDT_DURATION;
+	else if (duration > VSPM_WDT_DURATION_MAX)
+		duration = VSPM_WDT_DURATION_MAX;
+
+	/* identify the job in the event of the timer */
+	ch_info->seq++;
+
+	mod_timer(&ch_info->timer,
+		  jiffies + msecs_to_jiffies(duration * VSPM_WDT_MARGIN));
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_exec_stop_watchdog
+ * Description:	Stop the watchdog of the job.
+ *	An event already sent by the timer is ignored by
+ *	vspm_ins_exec_timeout(), because the sequence is changed.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_ins_exec_stop_watchdog(struct vspm_wdt_ch_info *ch_info)
+{
+	del_timer_sync(&ch_info->timer);
+	ch_info->seq++;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_exec_on_timer
+ * Description:	Timer handler of the watchdog.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_ins_exec_on_timer(struct timer_list *t)
+{
+	struct vspm_wdt_ch_info *ch_info = from_timer(ch_info, t, timer);
+
+	vspm_inc_ctrl_on_watchdog(ch_info->module_id, ch_info->seq);
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_exec_reset_work
+ * Description:	Stop and reset the IPs timed out.
+ *	This is executed out of the VSPM thread, and the other IPs continue
+ *	to execute the jobs while an IP is being reset.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_ins_exec_reset_work(struct work_struct *work)
+{
+	struct vspm_wdt_info *wdt_info =
+		container_of(work, struct vspm_wdt_info, work);
+	unsigned short module_id;
+
+	long ercd;
+
+	for (module_id = 0; module_id < VSPM_CH_MAX; module_id++) {
+		if (!test_and_clear_bit(module_id, &wdt_info->reset_bits))
+			continue;
+
+		if (IS_VSP_CH(module_id))
+			ercd = vspm_ins_vsp_recover(module_id);
+		else
+			ercd = vspm_ins_fdp_recover(module_id);
+
+		vspm_inc_ctrl_on_recovered(module_id, ercd);
+	}
+}
+
 /******************************************************************************
  * Function:		vspm_ins_exec_start
  * Description:	Execute job.
@@ -76,8 +151,11 @@ long vspm_ins_exec_start(
 	struct vspm_exec_info *exec_info,
 	unsigned short module_id,
 	struct vspm_job_t *ip_par,
-	struct vspm_job_info *job_info)
+	struct vspm_job_info *job_info,
+	unsigned char split_idx,
+	unsigned char split_num)
 {
+	struct vspm_exec_ch_info *ch_info = &exec_info->ch_info[module_id];
 	struct vspm_request_res_info *request;
 	unsigned int channel_bit = VSPM_CH_TO_BIT(module_id);
 	long ercd;
@@ -90,16 +168,22 @@ long vspm_ins_exec_start(
 
 	/* Update the execution information */
 	exec_info->exec_ch_bits |= channel_bit;
-	exec_info->p_exec_job_info[module_id] = job_info;
+	ch_info->job_info = job_info;
+
+	/* Get request information */
+	request = vspm_ins_job_get_request_param(job_info);
 
 	if (IS_VSP_CH(module_id)) {
 		/* Start the VSP process */
 		ercd = vspm_ins_vsp_execute(
-			module_id, ip_par->par.vsp);
+			module_id, ip_par->par.vsp,
+			split_idx, split_num, job_info);
+		if (!ercd) {
+			/* keep the configuration for the next job */
+			vspm_ins_vsp_get_config(
+				ip_par->par.vsp, &ch_info->vsp_config);
+		}
 	} else if (IS_FDP_CH(module_id)) {
-		/* Get request information */
-		request = vspm_ins_job_get_request_param(job_info);
-
 		/* Start the FDP process */
 		ercd = vspm_ins_fdp_execute(
 			module_id, ip_par->par.fdp, request);
@@ -110,11 +194,18 @@ long vspm_ins_exec_start(
 
 	if (ercd) {
 		/* Update the execution information */
-		exec_info->p_exec_job_info[module_id] = NULL;
+		ch_info->job_info = NULL;
 		exec_info->exec_ch_bits &= ~channel_bit;
+		return ercd;
 	}
 
-	return ercd;
+	/* watch hang of the IP, when the client requested */
+	if (request->watchdog) {
+		vspm_ins_exec_start_watchdog(
+			&ch_info->wdt, ip_par->duration);
+	}
+
+	return R_VSPM_OK;
 }
 
 /******************************************************************************
@@ -142,8 +233,10 @@ long vspm_ins_exec_complete(
 		return R_VSPM_NG;
 	}
 
+	vspm_ins_exec_stop_watchdog(&exec_info->ch_info[module_id].wdt);
+
 	/* clear common information */
-	exec_info->p_exec_job_info[module_id] = NULL;
+	exec_info->ch_info[module_id].job_info = NULL;
 	exec_info->exec_ch_bits &= VSPM_CH_TO_BIT_INVERT(module_id);
 
 	return R_VSPM_OK;
@@ -160,7 +253,7 @@ struct vspm_job_info *vspm_ins_exec_get_current_job_info(
 	if (!(exec_info->exec_ch_bits & VSPM_CH_TO_BIT(module_id)))
 		return NULL;
 
-	return exec_info->p_exec_job_info[module_id];
+	return exec_info->ch_info[module_id].job_info;
 }
 
 /******************************************************************************
@@ -172,6 +265,32 @@ void vspm_ins_exec_update_current_status(
 	struct vspm_exec_info *exec_info, struct vspm_usable_res_info *usable)
 {
 	usable->ch_bits &= ~exec_info->exec_ch_bits;
+
+	/* channels under recovery are not usable */
+	usable->ch_bits &= ~exec_info->wdt_info.recover_bits;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_exec_request_cancel
+ * Description:	Request to cancel the job without waiting.
+ *	vspm_ins_exec_cancel() completes the cancel.
+ * Returns:		R_VSPM_OK/R_VSPM_SEQERR/R_VSPM_PARAERR
+ *	return of vspm_ins_vsp_request_cancel()
+ *	return of vspm_ins_fdp_request_cancel()
+ ******************************************************************************/
+long vspm_ins_exec_request_cancel(
+	struct vspm_exec_info *exec_info, unsigned short module_id)
+{
+	if (!(exec_info->exec_ch_bits & VSPM_CH_TO_BIT(module_id)))
+		return R_VSPM_SEQERR;
+
+	if (IS_VSP_CH(module_id))
+		return vspm_ins_vsp_request_cancel(module_id);
+	else if (IS_FDP_CH(module_id))
+		return vspm_ins_fdp_request_cancel(module_id);
+
+	EPRINT("%s Invalid module_id 0x%04x\n", __func__, module_id);
+	return R_VSPM_PARAERR;
 }
 
 /******************************************************************************
@@ -206,10 +325,140 @@ long vspm_ins_exec_cancel(
 		return R_VSPM_PARAERR;
 	}
 
+	vspm_ins_exec_stop_watchdog(&exec_info->ch_info[module_id].wdt);
+
 	/* clear common information */
-	exec_info->p_exec_job_info[module_id] = NULL;
+	exec_info->ch_info[module_id].job_info = NULL;
 	exec_info->exec_ch_bits &= VSPM_CH_TO_BIT_INVERT(module_id);
 
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_exec_init_watchdog
+ * Description:	Initialize the watchdog of jobs.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_ins_exec_init_watchdog(struct vspm_exec_info *exec_info)
+{
+	struct vspm_wdt_info *wdt_info = &exec_info->wdt_info;
+	struct vspm_wdt_ch_info *ch_info;
+	unsigned short module_id;
+
+	for (module_id = 0; module_id < VSPM_CH_MAX; module_id++) {
+		ch_info = &exec_info->ch_info[module_id].wdt;
+		ch_info->module_id = module_id;
+		timer_setup(&ch_info->timer, vspm_ins_exec_on_timer, 0);
+	}
+
+	INIT_WORK(&wdt_info->work, vspm_ins_exec_reset_work);
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_exec_quit_watchdog
+ * Description:	Stop the watchdog and wait for the reset of IPs.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_ins_exec_quit_watchdog(struct vspm_exec_info *exec_info)
+{
+	struct vspm_wdt_info *wdt_info = &exec_info->wdt_info;
+	unsigned short module_id;
+
+	for (module_id = 0; module_id < VSPM_CH_MAX; module_id++)
+		del_timer_sync(&exec_info->ch_info[module_id].wdt.timer);
+
+	flush_work(&wdt_info->work);
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_exec_timeout
+ * Description:	Timeout of the job. The job is detached from the IP, and
+ *	the IP is reset by the work and is not usable until it is recovered.
+ *	The job is held until the reset, then retried or completed.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_exec_timeout(
+	struct vspm_exec_info *exec_info,
+	unsigned short module_id,
+	unsigned int seq)
+{
+	struct vspm_wdt_info *wdt_info = &exec_info->wdt_info;
+	struct vspm_exec_ch_info *exec_ch_info = &exec_info->ch_info[module_id];
+	struct vspm_wdt_ch_info *ch_info = &exec_ch_info->wdt;
+	unsigned int channel_bit = VSPM_CH_TO_BIT(module_id);
+
+	if (!(exec_info->exec_ch_bits & channel_bit))
+		return R_VSPM_NG;
+
+	/* event of a job which is not running any more */
+	if (seq != ch_info->seq)
+		return R_VSPM_NG;
+
+	/* ignore the event sent again */
+	ch_info->seq++;
+
+	EPRINT("%s hang of module_id=0x%04x\n", __func__, module_id);
+
+	/* hold the job while the IP may still access its buffers */
+	ch_info->job_info = exec_ch_info->job_info;
+
+	/* clear common information */
+	exec_ch_info->job_info = NULL;
+	exec_info->exec_ch_bits &= ~channel_bit;
+
+	/* reset the IP */
+	wdt_info->recover_bits |= channel_bit;
+	wdt_info->status.timeout_num++;
+	ch_info->hang_time = ktime_get();
+
+	set_bit(module_id, &wdt_info->reset_bits);
+	schedule_work(&wdt_info->work);
+
+	return R_VSPM_OK;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_exec_recovered
+ * Description:	The IP is reset and becomes usable.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_ins_exec_recovered(
+	struct vspm_exec_info *exec_info, unsigned short module_id)
+{
+	struct vspm_wdt_info *wdt_info = &exec_info->wdt_info;
+	unsigned long latency;
+
+	latency = (unsigned long)ktime_us_delta(
+		ktime_get(), exec_info->ch_info[module_id].wdt.hang_time);
+	if (wdt_info->status.latency < latency)
+		wdt_info->status.latency = latency;
+
+	wdt_info->recover_bits &= VSPM_CH_TO_BIT_INVERT(module_id);
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_exec_get_held_job
+ * Description:	Get the job held until the reset of the IP.
+ * Returns:		pointer of job information/On nothing is NULL.
+ ******************************************************************************/
+struct vspm_job_info *vspm_ins_exec_get_held_job(
+	struct vspm_exec_info *exec_info, unsigned short module_id)
+{
+	return exec_info->ch_info[module_id].wdt.job_info;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_exec_release_job
+ * Description:	Release the job held until the reset of the IP.
+ * Returns:		pointer of job information/On nothing is NULL.
+ ******************************************************************************/
+struct vspm_job_info *vspm_ins_exec_release_job(
+	struct vspm_exec_info *exec_info, unsigned short module_id)
+{
+	struct vspm_wdt_ch_info *ch_info = &exec_info->ch_info[module_id].wdt;
+	struct vspm_job_info *job_info = ch_info->job_info;
+
+	ch_info->job_info = NULL;
+
+	return job_info;
+}
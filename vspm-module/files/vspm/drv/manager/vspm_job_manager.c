@@ -106,9 +106,16 @@ struct vspm_job_info *vspm_ins_job_entry(
 	job_info->status = VSPM_JOB_STATUS_ENTRY;
 	job_info->job_id = VSPM_SET_JOB_ID(job_manager->entry_count, index);
 	job_info->ch_num = 0;
+	job_info->exec_bits = 0;
 	job_info->result = R_VSPM_OK;
 	job_info->entry	 = *entry;
 	job_info->next_job_info = NULL;
+	job_info->merge_job_info = NULL;
+	job_info->resume_part = 0;
+	job_info->preempt = 0;
+	job_info->preemptible = 0;
+	job_info->bypass_cnt = 0;
+	job_info->retry_cnt = 0;
 
 	return job_info;
 }
@@ -194,6 +201,7 @@ long vspm_ins_job_execute_start(
 
 	/* set channel bits */
 	job_info->ch_num = exec_ch;
+	job_info->exec_bits = VSPM_CH_TO_BIT(exec_ch);
 
 	/* update status */
 	job_info->status = VSPM_JOB_STATUS_EXECUTING;
@@ -201,6 +209,61 @@ long vspm_ins_job_execute_start(
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_job_execute_split
+ * Description:	Add the channel executing a split of the job.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_job_execute_split(
+	struct vspm_job_info *job_info, unsigned long exec_ch)
+{
+	if (job_info->status != VSPM_JOB_STATUS_EXECUTING) {
+		EPRINT("%s Illegal status %ld\n", __func__, job_info->status);
+		return R_VSPM_NG;
+	}
+
+	/* add channel bits */
+	job_info->exec_bits |= VSPM_CH_TO_BIT(exec_ch);
+
+	return R_VSPM_OK;
+}
+
+/******************************************************************************
+ * Function:		vspm_ins_job_execute_merge
+ * Description:	Set the job merged into an executing job.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_job_execute_merge(
+	struct vspm_job_info *job_info, struct vspm_job_info *merge_job_info)
+{
+	struct vspm_job_info **work_job_info;
+
+	if (job_info->status != VSPM_JOB_STATUS_EXECUTING ||
+	    merge_job_info->status != VSPM_JOB_STATUS_ENTRY) {
+		EPRINT("%s Illegal status %ld %ld\n",
+		       __func__, job_info->status, merge_job_info->status);
+		return R_VSPM_NG;
+	}
+
+	/* executed by the channel of the job */
+	merge_job_info->ch_num = job_info->ch_num;
+	merge_job_info->exec_bits = 0;
+	merge_job_info->merge_job_info = NULL;
+
+	/* add to the tail of merged jobs */
+	work_job_info = (struct vspm_job_info **)&job_info->merge_job_info;
+	while (*work_job_info) {
+		work_job_info = (struct vspm_job_info **)
+			&(*work_job_info)->merge_job_info;
+	}
+	*work_job_info = merge_job_info;
+
+	/* update status */
+	merge_job_info->status = VSPM_JOB_STATUS_EXECUTING;
+
+	return R_VSPM_OK;
+}
+
 /******************************************************************************
  * Function:		vspm_ins_job_execute_complete
  * Description:	Job completion processing.
@@ -214,18 +277,70 @@ long vspm_ins_job_execute_complete(
 		return R_VSPM_NG;
 	}
 
-	if (job_info->ch_num == comp_ch) {
+	if (!(job_info->exec_bits & VSPM_CH_TO_BIT(comp_ch)))
+		return R_VSPM_OK;
+
+	/* clear channel bits */
+	job_info->exec_bits &= VSPM_CH_TO_BIT_INVERT(comp_ch);
+
+	/* keep the first error of split */
+	if (job_info->result == R_VSPM_OK)
+		job_info->result = result;
+
+	if (job_info->exec_bits == 0) {
+		struct vspm_job_info *merge_job_info = job_info->merge_job_info;
+
 		/* call callback function */
 		job_info->entry.pfn_complete_cb(
-			job_info->job_id, result, job_info->entry.user_data);
+			job_info->job_id,
+			job_info->result,
+			job_info->entry.user_data);
 
 		/* update status */
 		job_info->status = VSPM_JOB_STATUS_EMPTY;
+		job_info->merge_job_info = NULL;
+
+		/* complete the merged jobs with the same result */
+		while (merge_job_info) {
+			merge_job_info->entry.pfn_complete_cb(
+				merge_job_info->job_id,
+				job_info->result,
+				merge_job_info->entry.user_data);
+
+			merge_job_info->status = VSPM_JOB_STATUS_EMPTY;
+			merge_job_info = merge_job_info->merge_job_info;
+		}
 	}
 
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_ins_job_execute_preempt
+ * Description:	Return the preempted job to the entry state.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_ins_job_execute_preempt(
+	struct vspm_job_info *job_info, unsigned int resume_part)
+{
+	if (job_info->status != VSPM_JOB_STATUS_EXECUTING) {
+		EPRINT("%s Illegal status %ld\n", __func__, job_info->status);
+		return R_VSPM_NG;
+	}
+
+	/* clear channel bits */
+	job_info->exec_bits = 0;
+
+	/* set partition to resume */
+	job_info->resume_part = resume_part;
+	job_info->preempt = 0;
+
+	/* update status */
+	job_info->status = VSPM_JOB_STATUS_ENTRY;
+
+	return R_VSPM_OK;
+}
+
 /******************************************************************************
  * Function:		vspm_ins_job_remove
  * Description:	Remove the job.
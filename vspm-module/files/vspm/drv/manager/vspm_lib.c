@@ -158,6 +158,30 @@ long vspm_lib_forced_cancel(struct vspm_privdata *priv)
 		&cancel);
 }
 
+/******************************************************************************
+ * Function:		vspm_lib_check_idle
+ * Description:	Check whether the handle has no queued or running job.
+ * Returns:		R_VSPM_OK
+ *	return of fw_send_function()
+ ******************************************************************************/
+long vspm_lib_check_idle(struct vspm_privdata *priv)
+{
+	struct vspm_request_res_info *request = &priv->request_info;
+	struct vspm_api_param_check_idle idle;
+
+	/* jobs of occupy mode are not managed */
+	if (request->mode != VSPM_MODE_MUTUAL)
+		return R_VSPM_OK;
+
+	idle.priv = priv;
+
+	return fw_send_function(
+		TASK_VSPM,
+		FUNCTIONID_VSPM_BASE + FUNC_VSPM_CHECK_IDLE,
+		sizeof(idle),
+		&idle);
+}
+
 /******************************************************************************
  * Function:		vspm_lib_set_mode
  * Description:	Set VSP manager operation mode.
@@ -188,17 +212,54 @@ long vspm_lib_get_status(
 	struct vspm_request_res_info *request = &priv->request_info;
 
 	/* check parameter */
-	if (!param->fdp)
+	if (!param->fdp && !param->pool && !param->recover)
 		return R_VSPM_PARAERR;
 
-	if (request->type != VSPM_TYPE_FDP_AUTO)
-		return R_VSPM_PARAERR;
+	if (param->fdp) {
+		if (request->type != VSPM_TYPE_FDP_AUTO)
+			return R_VSPM_PARAERR;
+
+		/* copy parameter */
+		memcpy(
+			param->fdp,
+			&request->fdp_info.status,
+			sizeof(struct fdp_status_t));
+	}
 
-	/* copy parameter */
-	memcpy(
-		param->fdp,
-		&request->fdp_info.status,
-		sizeof(struct fdp_status_t));
+	/* get usage of intermediate surface pool */
+	if (param->pool)
+		vspm_pool_get_status(param->pool);
+
+	/* get statistics of recovery from IP hang */
+	if (param->recover)
+		vspm_ins_ctrl_get_recover_status(param->recover);
 
 	return R_VSPM_OK;
 }
+
+/******************************************************************************
+ * Function:		vspm_lib_estimate
+ * Description:	Estimate the cost of the job.
+ * Returns:		R_VSPM_PARAERR
+ *	return of vspm_ins_ctrl_estimate()
+ ******************************************************************************/
+long vspm_lib_estimate(
+	struct vspm_privdata *priv,
+	struct vspm_job_t *ip_par,
+	struct vspm_estimate_t *param)
+{
+	struct vspm_request_res_info *request = &priv->request_info;
+
+	/* check parameter */
+	if (ip_par->type != VSPM_TYPE_VSP_AUTO)
+		return R_VSPM_PARAERR;
+
+	if (!ip_par->par.vsp || !param->vsp)
+		return R_VSPM_PARAERR;
+
+	if (request->type != VSPM_TYPE_VSP_AUTO)
+		return R_VSPM_PARAERR;
+
+	/* estimate */
+	return vspm_ins_ctrl_estimate(request, ip_par->par.vsp, param);
+}
@@ -117,6 +117,45 @@ long vspm_inc_sort_queue_entry(
 	return R_VSPM_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_inc_sort_queue_requeue
+ * Description:	Return a preempted job information to the queue ahead of
+ *	the jobs of the same priority.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_inc_sort_queue_requeue(
+	struct vspm_queue_info *queue_info, struct vspm_job_info *job_info)
+{
+	struct vspm_job_info **work_job_info;
+	unsigned short i;
+
+	/* check data counter */
+	if (queue_info->data_count >= VSPM_MAX_ELEMENTS) {
+		EPRINT("%s queue full\n", __func__);
+		return R_VSPM_NG;
+	}
+
+	/* entry queue */
+	job_info->next_job_info = NULL;
+	work_job_info = (struct vspm_job_info **)&queue_info->first_job_info;
+	for (i = 0; i < queue_info->data_count; i++) {
+		if (job_info->entry.job_priority >=
+			(*work_job_info)->entry.job_priority) {
+			job_info->next_job_info = (void *)(*work_job_info);
+			break;
+		}
+		work_job_info = (struct vspm_job_info **)
+			&(*work_job_info)->next_job_info;
+	}
+
+	*work_job_info = job_info;
+
+	/* increment data counter */
+	queue_info->data_count++;
+
+	return R_VSPM_OK;
+}
+
 /******************************************************************************
  * Function:		vspm_inc_sort_queue_refer
  * Description:	Get a job information from queue.
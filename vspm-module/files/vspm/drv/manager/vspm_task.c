@@ -120,6 +120,21 @@ static struct fw_func_tbl g_vspm_func_tbl[] = {
 		.msg_id	 = MSG_EVENT,
 		.func	 = vspm_inm_dispatch
 	},
+	[EVENT_VSPM_WATCHDOG - 1] = {
+		.func_id = FUNCTIONID_VSPM_BASE + EVENT_VSPM_WATCHDOG,
+		.msg_id	 = MSG_EVENT,
+		.func	 = vspm_inm_watchdog
+	},
+	[EVENT_VSPM_RECOVERED - 1] = {
+		.func_id = FUNCTIONID_VSPM_BASE + EVENT_VSPM_RECOVERED,
+		.msg_id	 = MSG_EVENT,
+		.func	 = vspm_inm_recovered
+	},
+	[FUNC_VSPM_CHECK_IDLE - 1] = {
+		.func_id = FUNCTIONID_VSPM_BASE + FUNC_VSPM_CHECK_IDLE,
+		.msg_id	 = MSG_FUNCTION,
+		.func	 = vspm_inm_check_idle
+	},
 	[EVENT_VSPM_MAX - 1] = {
 		.func_id = 0,
 		.msg_id	 = 0,
@@ -319,3 +334,56 @@ long vspm_inm_dispatch(void *mesp, void *para)
 	return FW_OK;
 }
 
+/******************************************************************************
+ * Function:		vspm_inm_watchdog
+ * Description:	Timeout of the job.
+ * Returns:		FW_OK
+ ******************************************************************************/
+long vspm_inm_watchdog(void *mesp, void *para)
+{
+	long ercd;
+	struct vspm_api_param_on_watchdog *api_param =
+		(struct vspm_api_param_on_watchdog *)para;
+
+	RESERVED(mesp);
+
+	ercd = vspm_ins_ctrl_on_watchdog(
+		api_param->module_id, api_param->seq);
+	if (ercd) {
+		EPRINT("%s failed to vspm_ins_ctrl_on_watchdog %ld\n",
+		       __func__, ercd);
+	}
+
+	return FW_OK;
+}
+
+/******************************************************************************
+ * Function:		vspm_inm_recovered
+ * Description:	Recovery of the IP is completed.
+ * Returns:		FW_OK
+ ******************************************************************************/
+long vspm_inm_recovered(void *mesp, void *para)
+{
+	struct vspm_api_param_on_complete *api_param =
+		(struct vspm_api_param_on_complete *)para;
+
+	RESERVED(mesp);
+
+	(void)vspm_ins_ctrl_on_recovered(
+		api_param->module_id, api_param->result);
+
+	return FW_OK;
+}
+
+/******************************************************************************
+ * Function:		vspm_inm_check_idle
+ * Description:	Check whether the handle has no job.
+ * Returns:		return of vspm_ins_ctrl_check_idle()
+ ******************************************************************************/
+long vspm_inm_check_idle(void *mesp, void *para)
+{
+	RESERVED(mesp);
+
+	return vspm_ins_ctrl_check_idle(
+		(struct vspm_api_param_check_idle *)para);
+}
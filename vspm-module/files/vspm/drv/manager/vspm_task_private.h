@@ -68,5 +68,8 @@ long vspm_inm_cancel(void *mesp, void *para);
 long vspm_inm_forced_cancel(void *mesp, void *para);
 long vspm_inm_set_mode(void *mesp, void *para);
 long vspm_inm_dispatch(void *mesp, void *para);
+long vspm_inm_watchdog(void *mesp, void *para);
+long vspm_inm_recovered(void *mesp, void *para);
+long vspm_inm_check_idle(void *mesp, void *para);
 
 #endif	/* __VSPM_TASK_PRIVATE_H__ */
@@ -56,6 +56,9 @@
  */ /*************************************************************************/
 
 #include <linux/slab.h>
+#include <linux/mutex.h>
+#include <linux/ktime.h>
+#include <linux/pm_runtime.h>
 
 #include "vspm_public.h"
 #include "vspm_ip_ctrl.h"
@@ -66,6 +69,10 @@
 
 static struct vsp_prv_data *g_vsp_obj[VSP_IP_MAX] = {NULL};
 
+/* work area of estimation */
+static struct vsp_prv_data *g_vsp_est;
+static DEFINE_MUTEX(g_vsp_est_lock);
+
 /******************************************************************************
  * Function:		vsp_lib_init
  * Description:	Initialize VSP driver
@@ -94,10 +101,15 @@ long vsp_lib_init(struct vsp_init_t *param)
 		/* update status */
 		prv->ch_info[0].status = VSP_STAT_INIT;
 		prv->ch_info[1].status = VSP_STAT_INIT;
+		init_waitqueue_head(&prv->idle_wq);
 
 		g_vsp_obj[i] = prv;
 	}
 
+	g_vsp_est = kzalloc(sizeof(struct vsp_prv_data), GFP_KERNEL);
+	if (!g_vsp_est)
+		goto err_exit;
+
 	return 0;
 
 err_exit:
@@ -149,6 +161,9 @@ long vsp_lib_quit(void)
 		prv++;
 	}
 
+	kfree(g_vsp_est);
+	g_vsp_est = NULL;
+
 	return 0;
 }
 
@@ -192,6 +207,7 @@ long vsp_lib_open(unsigned char ch, struct vsp_open_t *param)
 	}
 
 	prv->pdev = param->pdev;
+	prv->rstc = param->rstc;
 
 	/* set open parameter */
 	ercd = vsp_ins_get_vsp_resource(prv);
@@ -217,6 +233,9 @@ long vsp_lib_open(unsigned char ch, struct vsp_open_t *param)
 	prv->ch_info[0].status = VSP_STAT_READY;
 	prv->ch_info[1].status = VSP_STAT_READY;
 
+	/* device is suspended while no job is running */
+	vsp_ins_idle_clock(prv);
+
 	return 0;
 
 err_exit3:
@@ -235,7 +254,6 @@ err_exit1:
  * Returns:		0/E_VSP_PARA_CH/E_VSP_NO_INIT/E_VSP_INVALID_STATE
  *	return of vsp_ins_unreg_ih()
  *	return of vsp_ins_quit_reg()
- *	return of vsp_ins_disable_clock()
  ******************************************************************************/
 long vsp_lib_close(unsigned char ch)
 {
@@ -262,16 +280,14 @@ long vsp_lib_close(unsigned char ch)
 	if (ercd)
 		return ercd;
 
+	/* release intermediate surface */
+	vsp_ins_free_cascade_buffer(prv);
+
 	/* Finalize register */
 	ercd = vsp_ins_quit_reg(prv);
 	if (ercd)
 		return ercd;
 
-	/* disable clock */
-	ercd = vsp_ins_disable_clock(prv);
-	if (ercd)
-		return ercd;
-
 	/* update status */
 	prv->ch_info[0].status = VSP_STAT_INIT;
 	prv->ch_info[1].status = VSP_STAT_INIT;
@@ -282,19 +298,61 @@ long vsp_lib_close(unsigned char ch)
 /******************************************************************************
  * Function:		vsp_lib_start
  * Description:	Start VSP processing
+ * Returns:		return of vsp_lib_start_split()
+ ******************************************************************************/
+long vsp_lib_start(
+	unsigned char ch,
+	void *callback,
+	struct vsp_start_t *param,
+	void *userdata)
+{
+	return vsp_lib_start_split(ch, callback, param, userdata, 0, 1);
+}
+
+/******************************************************************************
+ * Function:		vsp_lib_start_split
+ * Description:	Start VSP processing of a part of split partitions
+ * Returns:		return of vsp_lib_start_preempt()
+ ******************************************************************************/
+long vsp_lib_start_split(
+	unsigned char ch,
+	void *callback,
+	struct vsp_start_t *param,
+	void *userdata,
+	unsigned char split_idx,
+	unsigned char split_num)
+{
+	return vsp_lib_start_preempt(
+		ch, callback, param, userdata,
+		split_idx, split_num, VSP_PREEMPT_OFF);
+}
+
+/******************************************************************************
+ * Function:		vsp_lib_start_preempt
+ * Description:	Start VSP processing which can be preempted at partition
+ *	boundaries. Partitions before resume_part are skipped.
  * Returns:		0/E_VSP_PARA_CB/E_VSP_PARA_INPAR/E_VSP_PARA_CH
  *	E_VSP_NO_INIT/E_VSP_INVALID_STATE
+ *	return of vsp_ins_wake_clock()
  *	return of vsp_ins_check_start_parameter()
+ *	return of vsp_ins_check_cascade_parameter()
+ *	return of vsp_ins_check_damage_parameter()
+ *	return of vsp_ins_check_fill_parameter()
+ *	return of vsp_ins_check_downscale_parameter()
  *	return of vsp_ins_set_start_parameter()
  ******************************************************************************/
-long vsp_lib_start(
+long vsp_lib_start_preempt(
 	unsigned char ch,
 	void *callback,
 	struct vsp_start_t *param,
-	void *userdata)
+	void *userdata,
+	unsigned char split_idx,
+	unsigned char split_num,
+	unsigned int resume_part)
 {
 	struct vsp_prv_data *prv;
 	struct vsp_ch_info *ch_info;
+	struct vsp_start_t st_par;
 
 	long ercd;
 
@@ -305,6 +363,27 @@ long vsp_lib_start(
 	if (!param)
 		return E_VSP_PARA_INPAR;
 
+	/* use the extended members only when they are set */
+	vsp_ins_get_start_parameter(&st_par, param);
+	param = &st_par;
+
+	if ((split_num == 0) || (split_idx >= split_num))
+		return E_VSP_PARA_INPAR;
+
+	if (param->bus_mode > VSP_BUS_HIGH)
+		return E_VSP_PARA_INPAR;
+
+	if (param->hist_par && param->hist_par->ring) {
+		if (!param->hist_par->ring->slot ||
+		    param->hist_par->ring->slot_num == 0)
+			return E_VSP_PARA_INPAR;
+	}
+
+	/* resumption of split processing is not supported */
+	if ((resume_part != VSP_PREEMPT_OFF) &&
+	    (resume_part != 0) && (split_num != 1))
+		return E_VSP_PARA_INPAR;
+
 	/* check channel parameter */
 	if (ch >= VSP_IP_MAX)
 		return E_VSP_PARA_CH;
@@ -326,14 +405,43 @@ long vsp_lib_start(
 	if (!prv->vsp_reg)
 		return E_VSP_INVALID_STATE;
 
+	/* wait for copy of histogram of the previous job */
+	if (param->use_module & (VSP_HGO_USE | VSP_HGT_USE))
+		flush_work(&prv->hist_work);
+
+	/* wake up device */
+	ercd = vsp_ins_wake_clock(prv);
+	if (ercd)
+		return ercd;
+
 	/* update status */
 	ch_info->status = VSP_STAT_RUN;
 
+	/* set split information */
+	ch_info->split_idx = split_idx;
+	ch_info->split_num = split_num;
+
+	/* set partition to resume from */
+	if (resume_part != VSP_PREEMPT_OFF)
+		ch_info->preempt_info.first = resume_part;
+	else
+		ch_info->preempt_info.first = 0;
+
 	/* check start parameter */
-	ercd = vsp_ins_check_start_parameter(prv, param);
+	if (param->fill_par)
+		ercd = vsp_ins_check_fill_parameter(prv, param);
+	else if (param->cascade_par)
+		ercd = vsp_ins_check_cascade_parameter(prv, param);
+	else if (param->downscale_par)
+		ercd = vsp_ins_check_downscale_parameter(prv, param);
+	else if (param->damage_par)
+		ercd = vsp_ins_check_damage_parameter(prv, param);
+	else
+		ercd = vsp_ins_check_start_parameter(prv, param);
 	if (ercd) {
 		/* update status */
 		ch_info->status = VSP_STAT_READY;
+		vsp_ins_idle_clock(prv);
 
 		return ercd;
 	}
@@ -343,20 +451,114 @@ long vsp_lib_start(
 	if (ercd) {
 		/* update status */
 		ch_info->status = VSP_STAT_READY;
+		vsp_ins_idle_clock(prv);
 
 		return ercd;
 	}
 
+	/* set partition preemption */
+	vsp_ins_set_preempt_parameter(prv, param, resume_part);
+
+	/* statistics of display list */
+	prv->sdata.job_num++;
+	prv->sdata.dl_size +=
+		ch_info->next_dl_addr - ch_info->wpf_info.val_dl_addr;
+
+	/* statistics of intermediate surface */
+	if (param->cascade_par) {
+		prv->sdata.mid_size += ch_info->cascade_info.mid_size;
+	} else if (param->downscale_par) {
+		prv->sdata.mid_size += ch_info->downscale_info.mid_size;
+		prv->sdata.mid_saved += ch_info->downscale_info.mid_saved;
+	}
+
 	/* set callback information */
 	ch_info->cb_func = callback;
 	ch_info->cb_userdata = userdata;
 
+	ch_info->hist_cb_func = NULL;
+	ch_info->hist_cb_userdata = NULL;
+	ch_info->hist_ring = NULL;
+	if (param->hist_par) {
+		ch_info->hist_cb_func = param->hist_par->cb_func;
+		ch_info->hist_cb_userdata = param->hist_par->userdata;
+
+		/* assign frame sequence number in start order */
+		ch_info->hist_ring = param->hist_par->ring;
+		if (ch_info->hist_ring)
+			ch_info->hist_seq = ch_info->hist_ring->frame_cnt++;
+	}
+
+	/* set bus access mode */
+	vsp_ins_set_bus_mode(prv, vsp_ins_get_bus_mode(prv, param));
+
 	/* start */
 	vsp_ins_start_processing(prv);
 
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		vsp_lib_set_bus_mode
+ * Description:	Set bus access mode of jobs which do not specify it
+ * Returns:		0/E_VSP_PARA_INPAR/E_VSP_PARA_CH/E_VSP_NO_INIT
+ ******************************************************************************/
+long vsp_lib_set_bus_mode(unsigned char ch, unsigned char mode)
+{
+	/* check parameter */
+	if (mode > VSP_BUS_HIGH)
+		return E_VSP_PARA_INPAR;
+
+	/* check channel parameter */
+	if (ch >= VSP_IP_MAX)
+		return E_VSP_PARA_CH;
+
+	if (!g_vsp_obj[ch])
+		return E_VSP_NO_INIT;
+
+	g_vsp_obj[ch]->bdata.session = mode;
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		vsp_lib_preempt
+ * Description:	Request to stop VSP processing at the next partition boundary
+ * Returns:		0/E_VSP_PARA_CH/E_VSP_NO_INIT/E_VSP_INVALID_STATE
+ ******************************************************************************/
+long vsp_lib_preempt(unsigned char ch)
+{
+	struct vsp_prv_data *prv;
+	struct vsp_preempt_info *preempt_info;
+
+	/* check channel parameter */
+	if (ch >= VSP_IP_MAX)
+		return E_VSP_PARA_CH;
+
+	if (!g_vsp_obj[ch])
+		return E_VSP_NO_INIT;
+
+	prv = g_vsp_obj[ch];
+
+	/* check status */
+	if (prv->ch_info[prv->ridx].status != VSP_STAT_RUN)
+		return E_VSP_INVALID_STATE;
+
+	preempt_info = &prv->ch_info[prv->ridx].preempt_info;
+	if (!preempt_info->enable || preempt_info->request)
+		return E_VSP_INVALID_STATE;
+
+	/* last partition is running */
+	if (preempt_info->part_idx + 1 >= preempt_info->part_end)
+		return E_VSP_INVALID_STATE;
+
+	/* stop at the end of running partition */
+	preempt_info->req_time = ktime_get();
+	preempt_info->request = 1;
+
+	return 0;
+}
+
 /******************************************************************************
  * Function:		vsp_lib_abort
  * Description:	Forced stop of VSP processing
@@ -390,6 +592,70 @@ long vsp_lib_abort(unsigned char ch)
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		vsp_lib_request_abort
+ * Description:	Request forced stop of VSP processing without waiting.
+ *	vsp_lib_abort() waits for the stop, so the stop of several VSPs
+ *	progresses in parallel when it is requested to all of them first.
+ * Returns:		0/E_VSP_PARA_CH/E_VSP_NO_INIT
+ ******************************************************************************/
+long vsp_lib_request_abort(unsigned char ch)
+{
+	struct vsp_prv_data *prv;
+
+	/* check channel parameter */
+	if (ch >= VSP_IP_MAX)
+		return E_VSP_PARA_CH;
+
+	if (!g_vsp_obj[ch])
+		return E_VSP_NO_INIT;
+
+	prv = g_vsp_obj[ch];
+
+	/* check status */
+	if (prv->ch_info[0].status != VSP_STAT_RUN &&
+	    prv->ch_info[1].status != VSP_STAT_RUN)
+		return 0;
+
+	/* keep the device active even if the job ends now */
+	pm_runtime_get_noresume(&prv->pdev->dev);
+
+	vsp_ins_request_stop(prv);
+
+	vsp_ins_idle_clock(prv);
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		vsp_lib_recover
+ * Description:	Recover VSP from hang. The processing is stopped and
+ *	the hardware is reset.
+ * Returns:		0/E_VSP_PARA_CH/E_VSP_NO_INIT/E_VSP_INVALID_STATE
+ *	return of vsp_lib_abort()
+ *	return of vsp_ins_reset_reg()
+ ******************************************************************************/
+long vsp_lib_recover(unsigned char ch)
+{
+	struct vsp_prv_data *prv;
+
+	long ercd;
+
+	/* stop VSP processing */
+	ercd = vsp_lib_abort(ch);
+	if (ercd)
+		return ercd;
+
+	prv = g_vsp_obj[ch];
+
+	/* check status */
+	if (prv->ch_info[0].status == VSP_STAT_INIT)
+		return E_VSP_INVALID_STATE;
+
+	/* reset hardware */
+	return vsp_ins_reset_reg(prv);
+}
+
 /******************************************************************************
  * Function:		vsp_lib_get_status
  * Description:	Get status of VSP processing
@@ -422,6 +688,15 @@ long vsp_lib_get_status(unsigned char ch, struct vsp_status_t *status)
 	status->rpf_bits = prv->rdata.usable_rpf;
 	status->rpf_clut_bits = prv->rdata.usable_rpf_clut;
 	status->wpf_rot_bits = prv->rdata.usable_wpf_rot;
+	status->preempt_num = prv->pdata.num;
+	status->preempt_latency = prv->pdata.latency;
+	status->resume_part = prv->pdata.resume_part;
+	status->job_num = prv->sdata.job_num;
+	status->dl_size = prv->sdata.dl_size;
+	status->tbl_num = prv->sdata.tbl_num;
+	status->tbl_size = prv->sdata.tbl_size;
+	status->mid_size = prv->sdata.mid_size;
+	status->mid_saved = prv->sdata.mid_saved;
 
 	return 0;
 }
@@ -474,6 +749,7 @@ long vsp_lib_suspend(unsigned char ch)
  * Function:		vsp_lib_resume
  * Description:	Resume of VSP processing
  * Returns:		0
+ *	return of vsp_ins_enable_clock().
  *	return of vsp_ins_init_reg().
  *	return of vsp_ins_reg_ih().
  ******************************************************************************/
@@ -494,7 +770,12 @@ long vsp_lib_resume(unsigned char ch)
 		if (prv->ch_info[0].status == VSP_STAT_READY &&
 		    prv->ch_info[1].status == VSP_STAT_READY) {
 			/* reinitialize register */
+			ercd = vsp_ins_enable_clock(prv);
+			if (ercd)
+				return ercd;
+
 			ercd = vsp_ins_init_reg(prv);
+			vsp_ins_idle_clock(prv);
 			if (ercd)
 				return ercd;
 
@@ -509,3 +790,244 @@ long vsp_lib_resume(unsigned char ch)
 
 	return 0;
 }
+
+/******************************************************************************
+ * Function:		vsp_lib_estimate
+ * Description:	Estimate VSP processing without touching the hardware.
+ *	The display list is neither built nor checked.
+ * Returns:		0/E_VSP_PARA_INPAR/E_VSP_PARA_CH/E_VSP_NO_INIT
+ *	E_VSP_PARA_CASCADE
+ *	return of vsp_ins_check_start_parameter()
+ *	return of vsp_ins_check_damage_parameter()
+ *	return of vsp_ins_check_fill_parameter()
+ *	return of vsp_ins_check_downscale_parameter()
+ ******************************************************************************/
+long vsp_lib_estimate(
+	unsigned char ch,
+	struct vsp_start_t *param,
+	struct vsp_estimate_t *estimate)
+{
+	struct vsp_prv_data *prv;
+	struct vsp_ch_info *ch_info;
+	struct vsp_start_t st_par;
+	struct vsp_start_t *chk_par;
+
+	long ercd;
+
+	/* check parameter */
+	if (!param || !estimate)
+		return E_VSP_PARA_INPAR;
+
+	/* check channel parameter */
+	if (ch >= VSP_IP_MAX)
+		return E_VSP_PARA_CH;
+
+	if (!g_vsp_obj[ch] || !g_vsp_est)
+		return E_VSP_NO_INIT;
+
+	vsp_ins_get_start_parameter(&st_par, param);
+
+	/* cascade needs intermediate surface of every pass */
+	if (st_par.cascade_par)
+		return E_VSP_PARA_CASCADE;
+
+	mutex_lock(&g_vsp_est_lock);
+
+	/* copy usable resource of the channel */
+	prv = g_vsp_est;
+	prv->rdata = g_vsp_obj[ch]->rdata;
+
+	/* split number 0 marks estimation */
+	ch_info = &prv->ch_info[prv->widx];
+	memset(ch_info, 0, sizeof(*ch_info));
+
+	/* check start parameter */
+	if (st_par.fill_par) {
+		ercd = vsp_ins_check_fill_parameter(prv, &st_par);
+		chk_par = &ch_info->fill_info.st_par;
+	} else if (st_par.downscale_par) {
+		ercd = vsp_ins_check_downscale_parameter(prv, &st_par);
+		chk_par = &ch_info->downscale_info.st_par;
+	} else if (st_par.damage_par) {
+		ercd = vsp_ins_check_damage_parameter(prv, &st_par);
+		chk_par = &ch_info->damage_info.st_par;
+	} else {
+		ercd = vsp_ins_check_start_parameter(prv, &st_par);
+		chk_par = &st_par;
+	}
+
+	if (!ercd) {
+		/* get estimate information */
+		vsp_ins_get_estimate(prv, chk_par, estimate);
+
+		/* each filled rectangle has own display list */
+		if (st_par.fill_par) {
+			estimate->tbl_num = (unsigned short)(estimate->tbl_num *
+				ch_info->fill_info.pass_num);
+			estimate->read_size =
+				(unsigned long)estimate->tbl_num << 3;
+		}
+
+		/* each downscale pass has own display list */
+		if (st_par.downscale_par) {
+			estimate->tbl_num = (unsigned short)(estimate->tbl_num *
+				ch_info->downscale_info.pass_num);
+		}
+	}
+
+	mutex_unlock(&g_vsp_est_lock);
+
+	return ercd;
+}
+
+/******************************************************************************
+ * Function:		vsp_lib_get_resident_clut_bits
+ * Description:	Get RPF bits which the CLUT table has been loaded to
+ * Returns:		RPF bits
+ ******************************************************************************/
+unsigned int vsp_lib_get_resident_clut_bits(
+	unsigned char ch, struct vsp_dl_t *clut)
+{
+	struct vsp_prv_data *prv;
+
+	unsigned int rpf_bits = 0;
+	unsigned char i;
+
+	/* check parameter */
+	if (!clut)
+		return 0;
+
+	/* check channel parameter */
+	if (ch >= VSP_IP_MAX)
+		return 0;
+
+	if (!g_vsp_obj[ch])
+		return 0;
+	prv = g_vsp_obj[ch];
+
+	for (i = 0; i < VSP_RPF_MAX; i++) {
+		if (vsp_ins_is_tbl_resident(&prv->tdata.clut[i], clut))
+			rpf_bits |= (0x00000001U << i);
+	}
+
+	return rpf_bits;
+}
+
+/******************************************************************************
+ * Function:		vsp_lib_get_resident_tbl_num
+ * Description:	Get number of tables of the job already loaded to VSP
+ * Returns:		number of tables
+ ******************************************************************************/
+unsigned int vsp_lib_get_resident_tbl_num(
+	unsigned char ch, struct vsp_start_t *param)
+{
+	struct vsp_prv_data *prv;
+	struct vsp_src_t *src_par;
+
+	unsigned int cnt = 0;
+	unsigned char i;
+
+	/* check parameter */
+	if (!param)
+		return 0;
+
+	if (param->ext_id != VSP_START_EXT_ID ||
+	    !(param->option & VSP_OPT_TBL_RESIDENT))
+		return 0;
+
+	/* check channel parameter */
+	if (ch >= VSP_IP_MAX)
+		return 0;
+
+	if (!g_vsp_obj[ch])
+		return 0;
+	prv = g_vsp_obj[ch];
+
+	/* CLUT of RPF */
+	for (i = 0; (i < param->rpf_num) && (i < VSP_RPF_MAX); i++) {
+		src_par = param->src_par[i];
+		if (!src_par)
+			continue;
+
+		if (src_par->format != VSP_IN_RGB_CLUT_DATA &&
+		    src_par->format != VSP_IN_YUV_CLUT_DATA)
+			continue;
+
+		if (vsp_lib_get_resident_clut_bits(ch, src_par->clut))
+			cnt++;
+	}
+
+	if (!param->ctrl_par)
+		return cnt;
+
+	/* LUT */
+	if ((param->use_module & VSP_LUT_USE) && param->ctrl_par->lut) {
+		if (vsp_ins_is_tbl_resident(
+				&prv->tdata.lut, &param->ctrl_par->lut->lut))
+			cnt++;
+	}
+
+	/* CLU */
+	if ((param->use_module & VSP_CLU_USE) && param->ctrl_par->clu) {
+		if (vsp_ins_is_tbl_resident(
+				&prv->tdata.clu, &param->ctrl_par->clu->clu))
+			cnt++;
+	}
+
+	return cnt;
+}
+
+/******************************************************************************
+ * Function:		vsp_lib_get_part_range
+ * Description:	Get range of number of partitions without dry run
+ * Returns:		0/E_VSP_PARA_INPAR
+ ******************************************************************************/
+long vsp_lib_get_part_range(
+	struct vsp_start_t *param,
+	unsigned int *min_num,
+	unsigned int *max_num)
+{
+	/* check parameter */
+	if (!param || !param->dst_par || !min_num || !max_num)
+		return E_VSP_PARA_INPAR;
+
+	vsp_ins_get_part_range(param, min_num, max_num);
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		vsp_lib_get_split_num
+ * Description:	Get number of split which display list can contain
+ * Returns:		number of split(1: not split)
+ ******************************************************************************/
+unsigned char vsp_lib_get_split_num(
+	unsigned int part_num, unsigned short tbl_num, unsigned char max_num)
+{
+	unsigned char split_num;
+
+	if (part_num < max_num)
+		max_num = (unsigned char)part_num;
+
+	for (split_num = max_num; split_num > 1; split_num--) {
+		/* each split has a full body in 1st partition */
+		if (vsp_ins_get_split_tbl_num(part_num, split_num) <= tbl_num)
+			break;
+	}
+
+	return split_num;
+}
+
+/******************************************************************************
+ * Function:		vsp_lib_get_split_tbl_num
+ * Description:	Get table number of display list for the split job
+ * Returns:		table number
+ ******************************************************************************/
+unsigned int vsp_lib_get_split_tbl_num(
+	unsigned int part_num, unsigned char split_num)
+{
+	if (part_num < split_num)
+		split_num = (unsigned char)part_num;
+
+	return vsp_ins_get_split_tbl_num(part_num, split_num);
+}
@@ -85,14 +85,23 @@
 #define VSP_DL_HEAD_SIZE		128
 #define VSP_DL_BODY_SIZE		1408
 #define VSP_DL_PART_SIZE		384
+#define VSP_DL_TBL_MAX			16383
 
 /* define partition process */
 #define VSP_PART_SIZE			256
 #define VSP_PART_MARGIN			2
+#define VSP_STRIPE_MARGIN		4
 
-/* define status read counter */
-#define VSP_STATUS_LOOP_TIME	(2)
-#define VSP_STATUS_LOOP_CNT		(500)
+/* define bytes read by a job to select bus access mode */
+#define VSP_BUS_LOW_SIZE		(256 * 1024)
+#define VSP_BUS_HIGH_SIZE		(16 * 1024 * 1024)
+
+/* define status read interval(usec) and counter of reset */
+#define VSP_STATUS_LOOP_TIME	(10)
+#define VSP_STATUS_LOOP_CNT		(100000)
+
+/* define timeout of waiting for the end of jobs(msec) */
+#define VSP_WAIT_TIMEOUT		(1000)
 
 /* define module maximum */
 #define VSP_RPF_MAX				(5)
@@ -183,7 +192,8 @@
 	(VSP_LUT_USE |	\
 	 VSP_CLU_USE)
 
-#define VSP_BRS_USABLE_DPR	0
+#define VSP_BRS_USABLE_DPR \
+	(VSP_BRU_USE)
 
 /* define register offset */
 #define VSP_WPF0_CMD			(0x0000)
@@ -492,6 +502,7 @@
 #define VSP_UDS_SCALE_4_1		(0x0400)	/* quadruple */
 #define VSP_UDS_SCALE_8_1		(0x0200)
 #define VSP_UDS_SCALE_16_1		(0x0100)	/* maximum scale */
+#define VSP_UDS_SCALE_MAX		(0xFFFF)	/* minimum scale */
 #define VSP_UDS_SCALE_MANT		(0xF000)
 #define VSP_UDS_SCALE_FRAC		(0x0FFF)
 
@@ -566,6 +577,13 @@ struct vsp_part_info {
 	unsigned short div_size;	/* division size */
 	unsigned short margin;		/* margin size */
 	unsigned short sru_first_flag;
+	unsigned short split_flag;	/* split processing flag */
+	unsigned short x_coffset;	/* clipping offset of WPF */
+	unsigned short in_width;	/* input width of WPF */
+
+	unsigned int part_first;	/* first partition of split */
+	unsigned int part_end;		/* end partition of split */
+	unsigned int dl_offset;		/* display list offset of split */
 
 	unsigned int rpf_addr_y;
 	unsigned int rpf_addr_c0;
@@ -576,6 +594,109 @@ struct vsp_part_info {
 	unsigned int hgt_smppt;
 };
 
+/* stripe information structure */
+struct vsp_stripe_info {
+	unsigned short num;			/* number of stripes */
+	unsigned short height;		/* output lines of stripe */
+	unsigned short overlap;		/* overlapped output lines */
+	unsigned short done;		/* number of completed stripes */
+	unsigned short dst_height;	/* output lines of image */
+	unsigned short src_height;	/* source lines of stripe */
+
+	unsigned int rpf_addr_y;
+	unsigned int rpf_addr_c0;
+	unsigned int rpf_addr_c1;
+	unsigned int rpf_addr_ai;
+
+	unsigned int wpf_addr_y;
+	unsigned int wpf_addr_c0;
+	unsigned int wpf_addr_c1;
+
+	void (*cb_func)
+		(unsigned short line, unsigned short height, void *userdata);
+	void *cb_userdata;
+};
+
+/* intermediate surface information structure */
+struct vsp_mid_info {
+	struct vspm_pool_buf *buf;	/* surface of the pool */
+	void *virt_addr;		/* surface out of the pool */
+	dma_addr_t hard_addr;
+	size_t size;
+};
+
+/* cascade information structure */
+struct vsp_cascade_info {
+	unsigned char pass_num;		/* number of composition passes */
+	unsigned char layer_num;	/* upper layers per pass */
+
+	struct vsp_start_t st_par;	/* parameter of current pass */
+	struct vsp_ctrl_t ctrl_par;
+	struct vsp_bru_t bru_par;
+	struct vsp_src_t src_par;	/* intermediate surface of input */
+	struct vsp_alpha_unit_t alpha_par;
+	struct vsp_dst_t dst_par;	/* intermediate surface of output */
+	struct vsp_dst_t out_par;	/* output of last pass */
+
+	unsigned int surface_size;	/* size of one surface */
+	unsigned long mid_size;		/* bytes through intermediates */
+};
+
+/* damaged area information structure */
+struct vsp_damage_info {
+	struct vsp_damage_t area;	/* damaged area of composition */
+
+	struct vsp_start_t st_par;	/* parameter of damaged area */
+	struct vsp_src_t src_par[VSP_RPF_MAX];
+	struct vsp_dst_t dst_par;
+	struct vsp_ctrl_t ctrl_par;
+	struct vsp_bru_t bru_par;
+	struct vsp_bld_vir_t vir_par;
+};
+
+/* color fill information structure */
+struct vsp_fill_info {
+	unsigned char pass_num;		/* number of filled rectangles */
+
+	struct vsp_start_t st_par;	/* parameter of current rectangle */
+	struct vsp_src_t src_par;	/* virtual input of fill color */
+	struct vsp_alpha_unit_t alpha_par;
+	struct vsp_dst_t dst_par;
+};
+
+/* multi-pass downscale information structure */
+struct vsp_downscale_info {
+	unsigned char pass_num;		/* number of downscale passes */
+	unsigned short x_ratio[VSP_DOWNSCALE_PASS_MAX];
+	unsigned short y_ratio[VSP_DOWNSCALE_PASS_MAX];
+	unsigned short width[VSP_DOWNSCALE_PASS_MAX];	/* output of pass */
+	unsigned short height[VSP_DOWNSCALE_PASS_MAX];
+
+	struct vsp_start_t st_par;	/* parameter of current pass */
+	struct vsp_ctrl_t ctrl_par;
+	struct vsp_uds_t uds_par;
+	struct vsp_src_t src_par;	/* input of current pass */
+	struct vsp_alpha_unit_t alpha_par;
+	struct vsp_dst_t dst_par;	/* intermediate surface of output */
+
+	unsigned int hard_addr;		/* intermediate surface */
+	unsigned int surface_size;	/* size of one surface */
+	unsigned long mid_size;		/* bytes through intermediates */
+	unsigned long mid_saved;	/* bytes saved by packed format */
+};
+
+/* partition preemption information structure */
+struct vsp_preempt_info {
+	unsigned char enable;		/* stop at every partition */
+	unsigned char request;		/* preemption is requested */
+	unsigned int first;			/* partition to resume from */
+	unsigned int part_idx;		/* running partition */
+	unsigned int part_end;		/* end partition */
+	unsigned int head_addr;		/* DL header of running partition */
+	struct vsp_dl_t dl_par;		/* display list area */
+	ktime_t req_time;			/* time of preemption request */
+};
+
 /* RPF information structure */
 struct vsp_rpf_info {
 	unsigned int val_bsize;
@@ -714,6 +835,13 @@ struct vsp_src_info {
 	unsigned int master;
 };
 
+/* table residency information structure */
+struct vsp_tbl_info {
+	unsigned int hard_addr;
+	unsigned short tbl_num;
+	unsigned int tbl_gen;
+};
+
 /* channel information structure */
 struct vsp_ch_info {
 	unsigned char status;
@@ -721,13 +849,26 @@ struct vsp_ch_info {
 	void (*cb_func)
 		(unsigned long id, long ercd, void *userdata);
 	void *cb_userdata;
+	void (*hist_cb_func)(void *userdata);
+	void *hist_cb_userdata;
+	struct vsp_hist_ring_t *hist_ring;
+	unsigned int hist_seq;		/* frame sequence number of ring */
 
 	unsigned long reserved_rpf;
 	unsigned long reserved_module;
 
 	unsigned long next_module;
 
+	unsigned int next_dl_addr;
+	unsigned int head_dl_addr;
+
 	struct vsp_part_info part_info;
+	unsigned char split_idx;	/* index of split */
+	unsigned char split_num;	/* number of split(0: estimate) */
+	unsigned char tbl_resident;	/* skip tables already loaded */
+	struct vsp_stripe_info stripe_info;
+	struct vsp_preempt_info preempt_info;
+	struct vsp_mid_info mid_info;
 
 	struct vsp_src_info src_info[VSP_RPF_MAX + 1];
 	unsigned char src_idx;
@@ -737,8 +878,6 @@ struct vsp_ch_info {
 	unsigned char bru_cnt;
 	unsigned char brs_cnt;
 
-	unsigned int next_dl_addr;
-
 	struct vsp_rpf_info rpf_info[VSP_RPF_MAX];
 	struct vsp_sru_info sru_info;
 	struct vsp_uds_info uds_info;
@@ -752,14 +891,27 @@ struct vsp_ch_info {
 	struct vsp_brs_info brs_info;
 	struct vsp_shp_info shp_info;
 	struct vsp_wpf_info wpf_info;
+
+	/* work area of multi-pass jobs, a job uses one of them at most */
+	union {
+		struct vsp_cascade_info cascade_info;
+		struct vsp_damage_info damage_info;
+		struct vsp_fill_info fill_info;
+		struct vsp_downscale_info downscale_info;
+	};
 };
 
 /* private data structure */
 struct vsp_prv_data {
 	struct platform_device *pdev;
+	struct reset_control *rstc;	/* module reset */
 	void __iomem *vsp_reg;
 	void __iomem *fcp_reg;
 	struct resource *irq;
+	atomic_t irq_cnt;		/* interrupts left to the thread */
+	wait_queue_head_t idle_wq;	/* woken at the end of jobs */
+	ktime_t irq_time;		/* time of the last interrupt */
+	unsigned int irq_status;	/* VSP_STATUS at the last interrupt */
 	struct vsp_res_data {
 		unsigned int usable_rpf;
 		unsigned int usable_rpf_clut;
@@ -770,7 +922,43 @@ struct vsp_prv_data {
 		unsigned int start_reservation;
 		unsigned int burst_access;
 		bool burst_enable;
+		bool hard_restart;
 	} rdata;
+	struct vsp_bus_data {
+		unsigned char session;	/* mode of the session */
+		unsigned char mode;		/* mode set to hardware */
+	} bdata;
+	struct vsp_tbl_data {
+		struct vsp_tbl_info clut[VSP_RPF_MAX];
+		struct vsp_tbl_info lut;
+		struct vsp_tbl_info clu;
+	} tdata;
+	struct vsp_preempt_data {
+		unsigned int num;		/* number of preemptions */
+		unsigned int latency;	/* maximum latency(usec) */
+		unsigned int resume_part;
+	} pdata;
+	struct vsp_stat_data {
+		unsigned long job_num;	/* number of started jobs */
+		unsigned long dl_size;	/* bytes of display lists */
+		unsigned long tbl_num;	/* number of table uploads */
+		unsigned long tbl_size;	/* bytes of table uploads */
+		unsigned long mid_size;	/* bytes through intermediates */
+		unsigned long mid_saved;
+	} sdata;
+
+	struct work_struct hist_work;	/* deferred histogram copy */
+	struct vsp_hist_data {
+		unsigned long module;		/* HGO and HGT */
+		unsigned char rbuf;			/* read buffer */
+		struct vsp_hgo_info hgo_info;
+		struct vsp_hgt_info hgt_info;
+		void (*cb_func)(void *userdata);
+		void *cb_userdata;
+		struct vsp_hist_slot_t *slot;	/* slot of histogram ring */
+		unsigned int seq;
+		unsigned long long time;
+	} hdata;
 
 	struct vsp_ch_info ch_info[2];
 	unsigned char widx;
@@ -780,21 +968,68 @@ struct vsp_prv_data {
 /* define local functions */
 long vsp_ins_check_init_parameter(struct vsp_init_t *param);
 long vsp_ins_check_open_parameter(struct vsp_open_t *param);
+void vsp_ins_get_start_parameter(
+	struct vsp_start_t *st_par, struct vsp_start_t *param);
 long vsp_ins_check_start_parameter(
 	struct vsp_prv_data *prv, struct vsp_start_t *param);
+long vsp_ins_check_cascade_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *param);
+long vsp_ins_check_cascade_pass(
+	struct vsp_prv_data *prv,
+	struct vsp_start_t *param,
+	unsigned char pass);
+long vsp_ins_check_damage_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *param);
+long vsp_ins_check_fill_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *param);
+long vsp_ins_check_fill_pass(
+	struct vsp_prv_data *prv,
+	struct vsp_start_t *param,
+	unsigned char pass);
+long vsp_ins_check_downscale_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *param);
+long vsp_ins_check_downscale_pass(
+	struct vsp_prv_data *prv,
+	struct vsp_start_t *param,
+	unsigned char pass);
+unsigned int vsp_ins_get_split_tbl_num(
+	unsigned int part_num, unsigned int split_num);
+void vsp_ins_get_part_range(
+	struct vsp_start_t *param,
+	unsigned int *min_num,
+	unsigned int *max_num);
+void vsp_ins_get_estimate(
+	struct vsp_prv_data *prv,
+	struct vsp_start_t *param,
+	struct vsp_estimate_t *estimate);
+unsigned char vsp_ins_get_bus_mode(
+	struct vsp_prv_data *prv, struct vsp_start_t *param);
 
 long vsp_ins_set_start_parameter(
 	struct vsp_prv_data *prv, struct vsp_start_t *param);
+void vsp_ins_set_preempt_parameter(
+	struct vsp_prv_data *prv,
+	struct vsp_start_t *st_par,
+	unsigned int resume_part);
 void vsp_ins_start_processing(struct vsp_prv_data *prv);
+void vsp_ins_request_stop(struct vsp_prv_data *prv);
 long vsp_ins_stop_processing(struct vsp_prv_data *prv);
 long vsp_ins_wait_processing(struct vsp_prv_data *prv);
 
 long vsp_ins_get_vsp_resource(struct vsp_prv_data *prv);
 
+long vsp_ins_alloc_cascade_buffer(
+	struct vsp_prv_data *prv, struct vsp_ch_info *ch_info, size_t size);
+void vsp_ins_free_cascade_buffer(struct vsp_prv_data *prv);
+
 long vsp_ins_enable_clock(struct vsp_prv_data *prv);
 long vsp_ins_disable_clock(struct vsp_prv_data *prv);
+long vsp_ins_wake_clock(struct vsp_prv_data *prv);
+void vsp_ins_idle_clock(struct vsp_prv_data *prv);
 
 long vsp_ins_init_reg(struct vsp_prv_data *prv);
+long vsp_ins_reset_reg(struct vsp_prv_data *prv);
+void vsp_ins_set_bus_mode(struct vsp_prv_data *prv, unsigned char mode);
 long vsp_ins_quit_reg(struct vsp_prv_data *prv);
 
 void vsp_ins_cb_function(struct vsp_prv_data *prv, long ercd);
@@ -813,5 +1048,13 @@ unsigned int vsp_ins_get_line_luma(
 	unsigned short format, unsigned short offset);
 unsigned int vsp_ins_get_line_chroma(
 	unsigned short format, unsigned short offset);
+unsigned int vsp_ins_get_stripe_src_line(
+	struct vsp_ch_info *ch_info,
+	struct vsp_start_t *st_par,
+	unsigned int line,
+	unsigned char *exact);
+
+unsigned char vsp_ins_is_tbl_resident(
+	struct vsp_tbl_info *tbl_info, struct vsp_dl_t *tbl);
 
 #endif
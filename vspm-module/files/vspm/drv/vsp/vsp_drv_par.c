@@ -107,6 +107,34 @@ long vsp_ins_check_open_parameter(struct vsp_open_t *param)
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_get_start_parameter
+ * Description:	Copy start parameter. The extended members are cleared
+ *	unless the caller sets ext_id, because old callers don't set them.
+ * Returns:		void
+ ******************************************************************************/
+void vsp_ins_get_start_parameter(
+	struct vsp_start_t *st_par, struct vsp_start_t *param)
+{
+	unsigned char i;
+
+	if (param->ext_id == VSP_START_EXT_ID) {
+		*st_par = *param;
+		return;
+	}
+
+	memset(st_par, 0, sizeof(*st_par));
+
+	st_par->rpf_num = param->rpf_num;
+	st_par->rpf_order = param->rpf_order;
+	st_par->use_module = param->use_module;
+	for (i = 0; i < VSP_RPF_MAX; i++)
+		st_par->src_par[i] = param->src_par[i];
+	st_par->dst_par = param->dst_par;
+	st_par->ctrl_par = param->ctrl_par;
+	st_par->dl_par = param->dl_par;
+}
+
 /******************************************************************************
  * Function:		vsp_ins_get_dpr_route
  * Description:	Get route value of module
@@ -1437,12 +1465,20 @@ static long vsp_ins_check_wpf_rotation(
 	wpf_info->val_vszclip = VSP_WPF_VSZCLIP_VCEN;
 	wpf_info->val_vszclip |= (y_coffset << 16) | height;
 
+	/* save clipping position of partition */
+	part_info->x_coffset = (unsigned short)x_coffset;
+	part_info->in_width = (unsigned short)src_info->width;
+
 	/* check partition */
 	if (dst_par->rotation > VSP_ROT_V_FLIP) {
 		/* set partition flag */
 		part_info->div_flag = 1;
 	}
 
+	/* split processing needs partition */
+	if ((part_info->split_flag) && (part_info->div_flag == 0))
+		part_info->div_flag = 1;
+
 	/* decide division size of partition */
 	part_info->div_size *= part_info->div_flag;
 
@@ -3038,6 +3074,192 @@ static long vsp_ins_check_shp_param(
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_get_part_num
+ * Description:	Get number of partitions.
+ * Returns:		number of partitions.
+ ******************************************************************************/
+static unsigned int vsp_ins_get_part_num(struct vsp_ch_info *ch_info)
+{
+	struct vsp_part_info *part_info = &ch_info->part_info;
+
+	if (part_info->div_flag == 0)
+		return 1;
+
+	return VSP_ROUND_UP(
+		(ch_info->wpf_info.val_hszclip & 0x1fff),
+		part_info->div_size);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_get_uds_div_flag
+ * Description:	Get division factor of partition by UDS, as
+ *	vsp_ins_check_uds_param() sets it.
+ * Returns:		division factor.
+ ******************************************************************************/
+static unsigned int vsp_ins_get_uds_div_flag(unsigned short x_ratio)
+{
+	if (x_ratio < VSP_UDS_SCALE_8_1)
+		return 8;
+	else if (x_ratio < VSP_UDS_SCALE_4_1)
+		return 4;
+	else if (x_ratio < VSP_UDS_SCALE_2_1)
+		return 2;
+
+	return 1;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_get_part_range
+ * Description:	Get range of number of partitions without checking the
+ *	parameter. It is exact unless both SRU and UDS are used, because
+ *	partitions are decided by the later one in the route.
+ * Returns:		void
+ ******************************************************************************/
+void vsp_ins_get_part_range(
+	struct vsp_start_t *param,
+	unsigned int *min_num,
+	unsigned int *max_num)
+{
+	struct vsp_dst_t *dst_par = param->dst_par;
+	struct vsp_ctrl_t *ctrl_par = param->ctrl_par;
+
+	unsigned int width;
+	unsigned int min_flag = 0;
+	unsigned int max_flag = 0;
+	unsigned int flag;
+
+	if (dst_par->rotation > VSP_ROT_V_FLIP) {
+		/* WPF divides rotated output by the minimum size */
+		width = dst_par->height;
+		min_flag = 1;
+		max_flag = 1;
+	} else {
+		width = dst_par->width;
+
+		if ((param->use_module & VSP_SRU_USE) &&
+		    ctrl_par && ctrl_par->sru) {
+			flag = (ctrl_par->sru->mode == VSP_SRU_MODE2) ? 2 : 1;
+			min_flag = flag;
+			max_flag = flag;
+		}
+
+		if ((param->use_module & VSP_UDS_USE) &&
+		    ctrl_par && ctrl_par->uds) {
+			flag = vsp_ins_get_uds_div_flag(ctrl_par->uds->x_ratio);
+			if ((min_flag == 0) || (flag < min_flag))
+				min_flag = flag;
+			if (flag > max_flag)
+				max_flag = flag;
+		}
+
+		/* split processing needs partition */
+		if (min_flag == 0) {
+			min_flag = 1;
+			max_flag = 1;
+		}
+	}
+
+	*min_num = VSP_ROUND_UP(width, VSP_PART_SIZE * max_flag);
+	*max_num = VSP_ROUND_UP(width, VSP_PART_SIZE * min_flag);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_get_dl_tbl_num
+ * Description:	Get required table number of display list.
+ * Returns:		table number.
+ ******************************************************************************/
+static unsigned int vsp_ins_get_dl_tbl_num(unsigned int div_cnt)
+{
+	unsigned int tbl_num;
+
+	/* 1st partition (header and full body) */
+	tbl_num = VSP_DL_HEAD_SIZE + VSP_DL_BODY_SIZE;
+
+	/* 2nd partition or more (header and difference body) */
+	tbl_num +=
+		(VSP_DL_HEAD_SIZE + VSP_DL_PART_SIZE) *
+		(div_cnt - 1);
+
+	return tbl_num >> 3;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_get_split_tbl_num
+ * Description:	Get required table number of display list for the split
+ *	layout, which vsp_ins_set_split_range() sets.
+ * Returns:		table number.
+ ******************************************************************************/
+unsigned int vsp_ins_get_split_tbl_num(
+	unsigned int part_num, unsigned int split_num)
+{
+	unsigned int tbl_num = 0;
+	unsigned int first;
+	unsigned int end;
+	unsigned int i;
+
+	if (split_num <= 1)
+		return vsp_ins_get_dl_tbl_num(part_num);
+
+	for (i = 0; i < split_num; i++) {
+		first = part_num * i / split_num;
+		end = part_num * (i + 1) / split_num;
+		tbl_num += vsp_ins_get_dl_tbl_num(end - first);
+	}
+
+	return tbl_num;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_set_split_range
+ * Description:	Set partition range and display list offset of split.
+ * Returns:		required table number of display list.
+ ******************************************************************************/
+static unsigned int vsp_ins_set_split_range(struct vsp_ch_info *ch_info)
+{
+	struct vsp_part_info *part_info = &ch_info->part_info;
+
+	unsigned int part_num = vsp_ins_get_part_num(ch_info);
+	unsigned int split_num = ch_info->split_num;
+	unsigned int tbl_num = 0;
+	unsigned int first;
+	unsigned int end;
+	unsigned int i;
+
+	if (split_num <= 1) {
+		part_info->part_first = 0;
+		part_info->part_end = part_num;
+		part_info->dl_offset = 0;
+
+		/* resume preempted processing */
+		if (split_num == 1)
+			part_info->part_first = ch_info->preempt_info.first;
+
+		if (part_info->part_end <= part_info->part_first)
+			return VSP_DL_TBL_MAX + 1;
+
+		return vsp_ins_get_dl_tbl_num(
+			part_info->part_end - part_info->part_first);
+	}
+
+	/* display list area of preceding split */
+	for (i = 0; i < ch_info->split_idx; i++) {
+		first = part_num * i / split_num;
+		end = part_num * (i + 1) / split_num;
+		tbl_num += vsp_ins_get_dl_tbl_num(end - first);
+	}
+
+	part_info->part_first = part_num * i / split_num;
+	part_info->part_end = part_num * (i + 1) / split_num;
+	part_info->dl_offset = tbl_num << 3;
+
+	if (part_info->part_end <= part_info->part_first)
+		return VSP_DL_TBL_MAX + 1;
+
+	return tbl_num + vsp_ins_get_dl_tbl_num(
+		part_info->part_end - part_info->part_first);
+}
+
 /******************************************************************************
  * Function:		vsp_ins_check_dl_param
  * Description:	Check display list parameter.
@@ -3048,19 +3270,22 @@ static long vsp_ins_check_dl_param(
 {
 	struct vsp_wpf_info *wpf_info = &ch_info->wpf_info;
 
+	wpf_info->val_dl_addr = dl_param->hard_addr;
+
+	/* display list is not built in estimation */
+	if (!ch_info->split_num)
+		return 0;
+
 	/* check address */
 	if (dl_param->hard_addr == 0 ||
 	    !dl_param->virt_addr)
 		return E_VSP_PARA_DL_ADR;
 
 	/* check size */
-	if ((dl_param->tbl_num <
-			((VSP_DL_HEAD_SIZE + VSP_DL_BODY_SIZE) >> 3)) ||
-		dl_param->tbl_num > 16383)
+	if ((dl_param->tbl_num < vsp_ins_get_dl_tbl_num(1)) ||
+		dl_param->tbl_num > VSP_DL_TBL_MAX)
 		return E_VSP_PARA_DL_SIZE;
 
-	wpf_info->val_dl_addr = dl_param->hard_addr;
-
 	return 0;
 }
 
@@ -3245,6 +3470,11 @@ static long vsp_ins_check_connection_module_from_bru(
 			return ercd;
 
 		ch_info->reserved_module |= VSP_BRS_USE;
+
+		/* BRS output is blended as one of BRU inputs */
+		if (ch_info->next_module == VSP_BRU_USE &&
+		    !(param->use_module & VSP_BRU_USE))
+			return E_VSP_PARA_CONNECT;
 	}
 
 	if (param->use_module & VSP_BRU_USE) {
@@ -3337,69 +3567,169 @@ static long vsp_ins_check_output_module(
 /******************************************************************************
  * Function:		vsp_ins_check_partition
  * Description:	Check partition parameter.
- * Returns:		0/E_VSP_PARA_IN_WIDTHEX/E_VSP_PARA_IN_HEIGHTEX
- *	E_VSP_PARA_ALPHA_ASEL/E_VSP_PARA_OUT_XCOFFSET/E_VSP_PARA_OUT_YCOFFSET
- *	E_VSP_PARA_DL_SIZE/E_VSP_PARA_CONNECT
+ * Returns:		0/E_VSP_PARA_DL_SIZE/E_VSP_PARA_CONNECT
  ******************************************************************************/
 static long vsp_ins_check_partition(
 	struct vsp_ch_info *ch_info, struct vsp_start_t *st_par)
 {
 	struct vsp_part_info *part_info = &ch_info->part_info;
 
-	struct vsp_src_t *src_par = st_par->src_par[0];	/* input source 0 */
-	struct vsp_dst_t *dst_par = st_par->dst_par;
-	struct vsp_uds_t *uds_par = st_par->ctrl_par->uds;
 	struct vsp_dl_t *dl_par = &st_par->dl_par;
-
-	unsigned int div_cnt;
 	unsigned int tbl_num;
 
 	if (part_info->div_flag != 0) {
-		/* check extended area of RPF */
-		if (src_par->width_ex != 0)
-			return E_VSP_PARA_IN_WIDTHEX;
+		/* layer of BRS output is not moved in partition */
+		if ((ch_info->reserved_module & VSP_BRS_USE) &&
+		    st_par->ctrl_par->brs->connect == VSP_BRU_USE)
+			return E_VSP_PARA_CONNECT;
+
+		/* check display list size, except in estimation */
+		tbl_num = vsp_ins_set_split_range(ch_info);
+		if (ch_info->split_num && dl_par->tbl_num < tbl_num)
+			return E_VSP_PARA_DL_SIZE;
 
-		if (src_par->height_ex != 0)
-			return E_VSP_PARA_IN_HEIGHTEX;
+		/* set display list address of split */
+		ch_info->wpf_info.val_dl_addr += part_info->dl_offset;
 
-		/* check 1bit alpha plane of RPF */
-		if (src_par->alpha->asel == VSP_ALPHA_NUM4)
-			return E_VSP_PARA_ALPHA_ASEL;
+		/* check margin */
+		if (part_info->margin < VSP_PART_MARGIN)
+			part_info->margin = VSP_PART_MARGIN;
+	}
 
-		/* check clipping offset of WPF */
-		if (dst_par->x_coffset != 0)
-			return E_VSP_PARA_OUT_XCOFFSET;
+	return 0;
+}
 
-		if (dst_par->y_coffset != 0)
-			return E_VSP_PARA_OUT_YCOFFSET;
+/******************************************************************************
+ * Function:		vsp_ins_is_stripe_aligned
+ * Description:	Check whether stripe boundary keeps vertical phase.
+ * Returns:		VSP_TRUE/VSP_FALSE
+ ******************************************************************************/
+static unsigned char vsp_ins_is_stripe_aligned(
+	struct vsp_ch_info *ch_info,
+	struct vsp_start_t *st_par,
+	unsigned int line)
+{
+	struct vsp_src_t *src_par = st_par->src_par[0];	/* input source 0 */
 
-		/* check display list size */
-		div_cnt = VSP_ROUND_UP(
-			(ch_info->wpf_info.val_hszclip & 0x1fff),
-			part_info->div_size);
+	unsigned char exact = VSP_TRUE;
+	unsigned int src_line;
 
-		tbl_num = VSP_DL_HEAD_SIZE + VSP_DL_BODY_SIZE;
-		tbl_num +=
-			(VSP_DL_HEAD_SIZE + VSP_DL_PART_SIZE) *
-			(div_cnt - 1);
-		tbl_num >>= 3;
+	src_line = vsp_ins_get_stripe_src_line(ch_info, st_par, line, &exact);
 
-		if (dl_par->tbl_num < tbl_num)
-			return E_VSP_PARA_DL_SIZE;
+	/* vertical sub-sampled chroma */
+	if ((vsp_ins_get_line_luma(src_par->format, 1) == 0) ||
+	    (vsp_ins_get_line_chroma(src_par->format, 1) == 0)) {
+		if (src_line % 2)
+			exact = VSP_FALSE;
+	}
 
-		/* check connection */
-		if (st_par->use_module & VSP_UDS_USE) {
-			if (part_info->sru_first_flag == 1) {
-				if (uds_par->x_ratio > VSP_UDS_SCALE_1_1)
-					return E_VSP_PARA_CONNECT;
-			}
-		}
+	return exact;
+}
 
-		/* check margin */
-		if (part_info->margin < VSP_PART_MARGIN)
-			part_info->margin = VSP_PART_MARGIN;
+/******************************************************************************
+ * Function:		vsp_ins_check_stripe
+ * Description:	Check vertical stripe parameter.
+ * Returns:		0/E_VSP_PARA_STRIPE/E_VSP_PARA_DL_SIZE
+ ******************************************************************************/
+static long vsp_ins_check_stripe(
+	struct vsp_ch_info *ch_info, struct vsp_start_t *st_par)
+{
+	struct vsp_stripe_info *stripe_info = &ch_info->stripe_info;
+	struct vsp_rpf_info *rpf_info;
+	struct vsp_wpf_info *wpf_info = &ch_info->wpf_info;
+
+	struct vsp_stripe_t *stripe_par = st_par->stripe_par;
+	struct vsp_src_t *src_par = st_par->src_par[0];	/* input source 0 */
+	struct vsp_dst_t *dst_par = st_par->dst_par;
+
+	unsigned int height = wpf_info->val_vszclip & 0x1fff;
+	unsigned int align;
+	unsigned int overlap = 0;
+	unsigned int frame_num;
+	unsigned int temp;
+	unsigned char exact;
+
+	/* initialise */
+	memset(stripe_info, 0, sizeof(*stripe_info));
+	stripe_info->num = 1;
+	stripe_info->src_height = src_par->height;
+
+	if (!stripe_par)
+		return 0;
+
+	/* check connection */
+	if (st_par->rpf_num != 1)
+		return E_VSP_PARA_STRIPE;
+
+	if (st_par->use_module &
+	    (VSP_BRU_USE | VSP_BRS_USE | VSP_HGO_USE | VSP_HGT_USE))
+		return E_VSP_PARA_STRIPE;
+
+	/* output from top to bottom only */
+	if (dst_par->rotation != VSP_ROT_OFF &&
+	    dst_par->rotation != VSP_ROT_H_FLIP)
+		return E_VSP_PARA_STRIPE;
+
+	if (wpf_info->val_outfmt & VSP_WPF_OUTFMT_FCNL)
+		return E_VSP_PARA_STRIPE;
+
+	/* vertical clipping is used for overlapped lines */
+	if (dst_par->y_coffset != 0 || src_par->height_ex != 0)
+		return E_VSP_PARA_STRIPE;
+
+	if (stripe_par->height == 0)
+		return E_VSP_PARA_STRIPE;
+
+	/* align stripe boundary to zero phase of vertical scaling */
+	for (align = 1; align < height; align++) {
+		if (vsp_ins_is_stripe_aligned(ch_info, st_par, align))
+			break;
+	}
+
+	/* overlapped lines for vertical filter */
+	if (st_par->use_module & (VSP_SRU_USE | VSP_UDS_USE | VSP_SHP_USE)) {
+		overlap = VSP_ROUND_UP(VSP_STRIPE_MARGIN, align) * align;
+		while (vsp_ins_get_stripe_src_line(
+				ch_info, st_par, overlap, &exact) <
+				VSP_STRIPE_MARGIN)
+			overlap += align;
+
+		if (overlap > 255)
+			return E_VSP_PARA_STRIPE;
 	}
 
+	/* round up stripe height to the alignment */
+	temp = VSP_ROUND_UP(stripe_par->height, align) * align;
+	if (temp > height)
+		temp = height;
+	stripe_info->height = (unsigned short)temp;
+
+	stripe_info->num =
+		(unsigned short)VSP_ROUND_UP(height, stripe_info->height);
+	stripe_info->overlap = (unsigned short)overlap;
+	stripe_info->dst_height = (unsigned short)height;
+
+	/* save address */
+	rpf_info = &ch_info->rpf_info[ch_info->src_info[0].rpf_ch];
+	stripe_info->rpf_addr_y = rpf_info->val_addr_y;
+	stripe_info->rpf_addr_c0 = rpf_info->val_addr_c0;
+	stripe_info->rpf_addr_c1 = rpf_info->val_addr_c1;
+	stripe_info->rpf_addr_ai = rpf_info->val_addr_ai;
+
+	stripe_info->wpf_addr_y = wpf_info->val_addr_y;
+	stripe_info->wpf_addr_c0 = wpf_info->val_addr_c0;
+	stripe_info->wpf_addr_c1 = wpf_info->val_addr_c1;
+
+	/* set callback information */
+	stripe_info->cb_func = stripe_par->cb_func;
+	stripe_info->cb_userdata = stripe_par->userdata;
+
+	/* check display list size, except in estimation */
+	frame_num = vsp_ins_get_part_num(ch_info) * stripe_info->num;
+	if (ch_info->split_num &&
+	    st_par->dl_par.tbl_num < vsp_ins_get_dl_tbl_num(frame_num))
+		return E_VSP_PARA_DL_SIZE;
+
 	return 0;
 }
 
@@ -3412,6 +3742,7 @@ static long vsp_ins_check_partition(
  *	return of vsp_ins_check_independent_module()
  *	return of vsp_ins_check_output_module()
  *	return of vsp_ins_check_partition()
+ *	return of vsp_ins_check_stripe()
  ******************************************************************************/
 long vsp_ins_check_start_parameter(
 	struct vsp_prv_data *prv, struct vsp_start_t *param)
@@ -3435,6 +3766,20 @@ long vsp_ins_check_start_parameter(
 	ch_info->part_info.div_size = VSP_PART_SIZE;
 	ch_info->part_info.margin = 1;
 
+	/* tables are kept loaded only when the client requested */
+	ch_info->tbl_resident =
+		(param->option & VSP_OPT_TBL_RESIDENT) ? VSP_TRUE : VSP_FALSE;
+
+	/* check split processing */
+	if ((param->option & VSP_OPT_SPLIT) && (ch_info->split_num != 1)) {
+		/* histogram and stripe need all partitions */
+		if (!(param->use_module & (VSP_HGO_USE | VSP_HGT_USE)) &&
+		    !param->stripe_par)
+			ch_info->part_info.split_flag = 1;
+		else if (ch_info->split_num > 1)
+			return E_VSP_PARA_USEMODULE;
+	}
+
 	/* check connection module parameter (RPF->BRU or WPF) */
 	ercd = vsp_ins_check_connection_module_from_rpf(prv, param);
 	if (ercd)
@@ -3469,5 +3814,1223 @@ long vsp_ins_check_start_parameter(
 	if (ercd)
 		return ercd;
 
+	/* check vertical stripe */
+	ercd = vsp_ins_check_stripe(ch_info, param);
+	if (ercd)
+		return ercd;
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_check_cascade_parameter
+ * Description:	Check cascade composition and 1st pass parameter.
+ * Returns:		0/E_VSP_PARA_OUTPAR/E_VSP_PARA_CASCADE
+ *	return of vsp_ins_alloc_cascade_buffer()
+ *	return of vsp_ins_check_start_parameter()
+ ******************************************************************************/
+long vsp_ins_check_cascade_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *param)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_cascade_info *cascade_info = &ch_info->cascade_info;
+
+	struct vsp_cascade_t *cascade_par = param->cascade_par;
+	struct vsp_dst_t *dst_par = param->dst_par;
+	struct vsp_src_t *src_par = &cascade_info->src_par;
+	struct vsp_dst_t *mid_par = &cascade_info->dst_par;
+	struct vsp_alpha_unit_t *alpha_par = &cascade_info->alpha_par;
+
+	unsigned int rpf_cnt = 0;
+	unsigned int bits;
+	unsigned int buf_num;
+	unsigned short format;
+	unsigned char i;
+	long ercd;
+
+	/* check pointer */
+	if (!dst_par)
+		return E_VSP_PARA_OUTPAR;
+
+	/* check upper layers */
+	if ((cascade_par->layer_num == 0) ||
+	    (cascade_par->layer_num > VSP_CASCADE_LAYER_MAX) ||
+	    !cascade_par->layer)
+		return E_VSP_PARA_CASCADE;
+
+	for (i = 0; i < cascade_par->layer_num; i++) {
+		if (!cascade_par->layer[i].src_par)
+			return E_VSP_PARA_CASCADE;
+
+		/* upper layer is input to BRU directly */
+		if (cascade_par->layer[i].src_par->connect != VSP_BRU_USE)
+			return E_VSP_PARA_CASCADE;
+	}
+
+	/* histogram and stripe are not cascaded */
+	if ((param->use_module & (VSP_HGO_USE | VSP_HGT_USE)) ||
+	    param->stripe_par)
+		return E_VSP_PARA_CASCADE;
+
+	/* damaged area and multi-pass downscaling are not cascaded */
+	if (param->damage_par || param->downscale_par)
+		return E_VSP_PARA_CASCADE;
+
+	/* count usable RPF */
+	bits = prv->rdata.usable_rpf;
+	while (bits) {
+		rpf_cnt += (bits & 0x1);
+		bits >>= 1;
+	}
+
+	if (rpf_cnt > VSP_BRU_IN_MAX)
+		rpf_cnt = VSP_BRU_IN_MAX;
+
+	if (rpf_cnt < 2)
+		return E_VSP_PARA_CASCADE;
+
+	/* decide number of passes */
+	cascade_info->layer_num = (unsigned char)(rpf_cnt - 1);
+	cascade_info->pass_num = (unsigned char)(1 + VSP_ROUND_UP(
+		cascade_par->layer_num, cascade_info->layer_num));
+
+	/* intermediate surface keeps color space of WPF input */
+	if (((dst_par->format & 0x40) == 0x40) ^
+		 (dst_par->csc == VSP_CSC_ON))
+		format = VSP_IN_YUV444_INTERLEAVED;
+	else
+		format = VSP_IN_ARGB8888;
+
+	/* set output parameter of last pass */
+	cascade_info->out_par = *dst_par;
+	cascade_info->out_par.x_coffset = 0;
+	cascade_info->out_par.y_coffset = 0;
+
+	/* set output parameter of intermediate surface */
+	memset(mid_par, 0, sizeof(struct vsp_dst_t));
+	if (dst_par->rotation <= VSP_ROT_180) {
+		mid_par->width = dst_par->width;
+		mid_par->height = dst_par->height;
+		mid_par->x_coffset = dst_par->x_coffset;
+		mid_par->y_coffset = dst_par->y_coffset;
+	} else {
+		mid_par->width = dst_par->height;
+		mid_par->height = dst_par->width;
+		mid_par->x_coffset = dst_par->y_coffset;
+		mid_par->y_coffset = dst_par->x_coffset;
+	}
+	mid_par->stride = (unsigned short)(VSP_ROUND_UP(
+		vsp_ins_get_bpp_luma(format, mid_par->width), 256) * 256);
+	mid_par->format = format;
+	mid_par->pxa = VSP_PAD_IN;
+	mid_par->rotation = VSP_ROT_OFF;
+
+	/* set input parameter of intermediate surface */
+	memset(src_par, 0, sizeof(struct vsp_src_t));
+	src_par->stride = mid_par->stride;
+	src_par->width = mid_par->width;
+	src_par->height = mid_par->height;
+	src_par->format = format;
+	src_par->pwd = VSP_LAYER_PARENT;
+	src_par->vir = VSP_NO_VIR;
+	src_par->alpha = alpha_par;
+	src_par->connect = VSP_BRU_USE;
+
+	memset(alpha_par, 0, sizeof(struct vsp_alpha_unit_t));
+	if (format == VSP_IN_ARGB8888) {
+		alpha_par->asel = VSP_ALPHA_NUM1;
+		alpha_par->aext = VSP_AEXT_EXPAN;
+	} else {
+		alpha_par->asel = VSP_ALPHA_NUM5;
+		alpha_par->afix = 0xff;
+	}
+
+	/* allocate intermediate surface */
+	cascade_info->surface_size =
+		(unsigned int)mid_par->stride * (unsigned int)mid_par->height;
+	buf_num = (cascade_info->pass_num > 2) ? 2 : 1;
+
+	ercd = vsp_ins_alloc_cascade_buffer(
+		prv, ch_info, (size_t)cascade_info->surface_size * buf_num);
+	if (ercd)
+		return ercd;
+
+	mid_par->addr = (unsigned int)ch_info->mid_info.hard_addr;
+
+	/* each intermediate surface is written once and read once */
+	cascade_info->mid_size = (unsigned long)vsp_ins_get_bpp_luma(
+		format, mid_par->width) * mid_par->height *
+		(cascade_info->pass_num - 1) * 2;
+
+	/* check 1st pass */
+	cascade_info->st_par = *param;
+	cascade_info->st_par.dst_par = mid_par;
+	cascade_info->st_par.option = 0;
+	cascade_info->st_par.cascade_par = NULL;
+
+	return vsp_ins_check_start_parameter(prv, &cascade_info->st_par);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_get_cascade_rpf_order
+ * Description:	Assign RPF channels of cascade pass.
+ * Returns:		0/E_VSP_BUSY_RPF_OVER
+ ******************************************************************************/
+static long vsp_ins_get_cascade_rpf_order(
+	struct vsp_prv_data *prv, struct vsp_start_t *st_par)
+{
+	unsigned int usable = prv->rdata.usable_rpf;
+	unsigned int clut = prv->rdata.usable_rpf_clut;
+
+	unsigned int bits;
+	unsigned short format;
+	unsigned char rpf_ch;
+	unsigned char i;
+
+	st_par->rpf_order = 0;
+	for (i = 0; i < st_par->rpf_num; i++) {
+		format = st_par->src_par[i]->format;
+
+		if ((format == VSP_IN_RGB_CLUT_DATA) ||
+		    (format == VSP_IN_YUV_CLUT_DATA)) {
+			/* RPF supported CLUT */
+			bits = usable & clut;
+		} else {
+			/* prefer RPF unsupported CLUT */
+			bits = usable & ~clut;
+			if (bits == 0)
+				bits = usable;
+		}
+
+		if (bits == 0)
+			return E_VSP_BUSY_RPF_OVER;
+
+		/* lowest channel */
+		rpf_ch = 0;
+		while (!(bits & (0x1U << rpf_ch)))
+			rpf_ch++;
+
+		usable &= ~(0x1U << rpf_ch);
+		st_par->rpf_order |= ((unsigned long)rpf_ch) << (i * 4);
+	}
+
 	return 0;
 }
+
+/******************************************************************************
+ * Function:		vsp_ins_check_cascade_pass
+ * Description:	Check parameter of 2nd or later cascade pass.
+ * Returns:		0/E_VSP_PARA_DL_SIZE
+ *	return of vsp_ins_get_cascade_rpf_order()
+ *	return of vsp_ins_check_start_parameter()
+ ******************************************************************************/
+long vsp_ins_check_cascade_pass(
+	struct vsp_prv_data *prv,
+	struct vsp_start_t *param,
+	unsigned char pass)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_cascade_info *cascade_info = &ch_info->cascade_info;
+
+	struct vsp_start_t *st_par = &cascade_info->st_par;
+	struct vsp_bru_t *bru_par = &cascade_info->bru_par;
+	struct vsp_layer_t *layer;
+
+	unsigned int first;
+	unsigned int num;
+	unsigned int used;
+	unsigned int i;
+	long ercd;
+
+	/* get upper layers of pass */
+	first = (pass - 1) * cascade_info->layer_num;
+	num = param->cascade_par->layer_num - first;
+	if (num > cascade_info->layer_num)
+		num = cascade_info->layer_num;
+	layer = &param->cascade_par->layer[first];
+
+	/* set BRU parameter */
+	/* intermediate surface is the bottom layer */
+	memset(bru_par, 0, sizeof(struct vsp_bru_t));
+	bru_par->lay_order =
+		((unsigned long)VSP_LAY_1) << (VSP_BROP_DST_A * 4);
+	bru_par->lay_order |=
+		((unsigned long)VSP_LAY_2) << (VSP_BROP_SRC_A * 4);
+	bru_par->blend_unit_a = layer[0].blend_unit;
+
+	if (num > 1) {
+		bru_par->lay_order |=
+			((unsigned long)VSP_LAY_3) << (VSP_BROP_SRC_C * 4);
+		bru_par->blend_unit_c = layer[1].blend_unit;
+	}
+
+	if (num > 2) {
+		bru_par->lay_order |=
+			((unsigned long)VSP_LAY_4) << (VSP_BROP_SRC_D * 4);
+		bru_par->blend_unit_d = layer[2].blend_unit;
+	}
+
+	if (num > 3) {
+		bru_par->lay_order |=
+			((unsigned long)VSP_LAY_5) << (VSP_BROP_SRC_E * 4);
+		bru_par->blend_unit_e = layer[3].blend_unit;
+	}
+
+	memset(&cascade_info->ctrl_par, 0, sizeof(struct vsp_ctrl_t));
+	cascade_info->ctrl_par.bru = bru_par;
+
+	/* swap intermediate surfaces */
+	cascade_info->src_par.addr = (unsigned int)ch_info->mid_info.hard_addr +
+		cascade_info->surface_size * ((pass - 1) % 2);
+	cascade_info->dst_par.addr = (unsigned int)ch_info->mid_info.hard_addr +
+		cascade_info->surface_size * (pass % 2);
+	cascade_info->dst_par.x_coffset = 0;
+	cascade_info->dst_par.y_coffset = 0;
+
+	/* set pass parameter */
+	memset(st_par, 0, sizeof(struct vsp_start_t));
+	st_par->rpf_num = (unsigned char)(num + 1);
+	st_par->use_module = VSP_BRU_USE;
+	st_par->src_par[0] = &cascade_info->src_par;
+	for (i = 0; i < num; i++)
+		st_par->src_par[i + 1] = layer[i].src_par;
+
+	if (pass + 1 < cascade_info->pass_num)
+		st_par->dst_par = &cascade_info->dst_par;
+	else
+		st_par->dst_par = &cascade_info->out_par;
+	st_par->ctrl_par = &cascade_info->ctrl_par;
+
+	/* display list follows preceding pass */
+	used = ch_info->next_dl_addr - param->dl_par.hard_addr;
+	if ((used >> 3) >= param->dl_par.tbl_num)
+		return E_VSP_PARA_DL_SIZE;
+
+	st_par->dl_par = param->dl_par;
+	st_par->dl_par.hard_addr += used;
+	st_par->dl_par.virt_addr =
+		(void *)((unsigned long)param->dl_par.virt_addr + used);
+	st_par->dl_par.tbl_num -= (unsigned short)(used >> 3);
+
+	/* assign RPF channel */
+	ercd = vsp_ins_get_cascade_rpf_order(prv, st_par);
+	if (ercd)
+		return ercd;
+
+	return vsp_ins_check_start_parameter(prv, st_par);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_clip_damage_layer
+ * Description:	Clip layer to damaged area of composition.
+ * Returns:		VSP_TRUE/VSP_FALSE(layer is out of damaged area)
+ ******************************************************************************/
+static unsigned char vsp_ins_clip_damage_layer(
+	struct vsp_damage_t *area,
+	unsigned short *x_position,
+	unsigned short *y_position,
+	unsigned short *width,
+	unsigned short *height,
+	unsigned short *x_skip,
+	unsigned short *y_skip)
+{
+	unsigned int left = *x_position;
+	unsigned int top = *y_position;
+	unsigned int right = left + *width;
+	unsigned int bottom = top + *height;
+
+	/* intersect with damaged area */
+	if (left < area->x_offset)
+		left = area->x_offset;
+	if (top < area->y_offset)
+		top = area->y_offset;
+	if (right > (unsigned int)area->x_offset + area->width)
+		right = (unsigned int)area->x_offset + area->width;
+	if (bottom > (unsigned int)area->y_offset + area->height)
+		bottom = (unsigned int)area->y_offset + area->height;
+
+	if ((left >= right) || (top >= bottom))
+		return VSP_FALSE;
+
+	/* skipped pixels of layer */
+	*x_skip = (unsigned short)(left - *x_position);
+	*y_skip = (unsigned short)(top - *y_position);
+
+	/* position from top-left of damaged area */
+	*x_position = (unsigned short)(left - area->x_offset);
+	*y_position = (unsigned short)(top - area->y_offset);
+	*width = (unsigned short)(right - left);
+	*height = (unsigned short)(bottom - top);
+
+	return VSP_TRUE;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_drop_damage_layer
+ * Description:	Remove layer out of damaged area from BRU.
+ * Returns:		VSP_TRUE/VSP_FALSE(layer can't be removed)
+ ******************************************************************************/
+static unsigned char vsp_ins_drop_damage_layer(
+	struct vsp_bru_t *bru_par, unsigned char drop)
+{
+	unsigned long order = 0;
+	unsigned char input = (drop == VSP_LAY_5) ? 5 : drop;
+	unsigned char layer;
+	unsigned char idx;
+	unsigned char i;
+
+	for (i = 0; i < VSP_BROP_MAX; i++) {
+		layer = (unsigned char)((bru_par->lay_order >> (i * 4)) & 0xf);
+
+		if (layer == drop) {
+			/* destination of blend and ROP is necessary */
+			if ((i == VSP_BROP_DST_A) || (i == VSP_BROP_DST_R))
+				return VSP_FALSE;
+			layer = VSP_LAY_NO;
+		} else if ((drop != VSP_LAY_VIRTUAL) &&
+			   (layer != VSP_LAY_NO) &&
+			   (layer != VSP_LAY_VIRTUAL)) {
+			/* close up upper input sources */
+			idx = (layer == VSP_LAY_5) ? 5 : layer;
+			if (idx > input)
+				layer = idx - 1;
+		}
+
+		order |= ((unsigned long)layer) << (i * 4);
+	}
+	bru_par->lay_order = order;
+
+	/* close up dither units */
+	if (drop != VSP_LAY_VIRTUAL) {
+		for (i = input; i < 5; i++)
+			bru_par->dither_unit[i - 1] = bru_par->dither_unit[i];
+		bru_par->dither_unit[4] = NULL;
+	}
+
+	return VSP_TRUE;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_crop_damage_parameter
+ * Description:	Crop windows of RPF, BRU and WPF to damaged area.
+ * Returns:		VSP_TRUE/VSP_FALSE(whole area is necessary)
+ ******************************************************************************/
+static unsigned char vsp_ins_crop_damage_parameter(
+	struct vsp_damage_info *damage_info, struct vsp_start_t *param)
+{
+	struct vsp_damage_t *damage_par = param->damage_par;
+	struct vsp_damage_t *area = &damage_info->area;
+	struct vsp_start_t *st_par = &damage_info->st_par;
+	struct vsp_dst_t *dst_par = &damage_info->dst_par;
+	struct vsp_bru_t *bru_par = NULL;
+	struct vsp_bld_vir_t *vir_par;
+	struct vsp_src_t *src_par;
+
+	unsigned int right;
+	unsigned int bottom;
+	unsigned short x_skip;
+	unsigned short y_skip;
+	unsigned char src_idx = 0;
+	unsigned char layer;
+	unsigned char i;
+
+	/* scaling, filter and histogram need whole area */
+	if (param->use_module & (VSP_SRU_USE | VSP_UDS_USE | VSP_SHP_USE |
+			VSP_HGO_USE | VSP_HGT_USE | VSP_BRS_USE))
+		return VSP_FALSE;
+
+	if (param->stripe_par || param->cascade_par)
+		return VSP_FALSE;
+
+	if ((param->rpf_num == 0) || (param->rpf_num > VSP_RPF_MAX))
+		return VSP_FALSE;
+
+	/* output is written in raster order */
+	if (param->dst_par->rotation != VSP_ROT_OFF)
+		return VSP_FALSE;
+
+	if (param->dst_par->fcp &&
+	    (param->dst_par->fcp->fcnl == FCP_FCNL_ENABLE))
+		return VSP_FALSE;
+
+	if ((param->use_module & VSP_BRU_USE) &&
+	    (!param->ctrl_par || !param->ctrl_par->bru))
+		return VSP_FALSE;
+
+	/* align damaged area to chroma subsampling */
+	right = (unsigned int)damage_par->x_offset + damage_par->width;
+	right = VSP_ROUND_UP(right, 2) * 2;
+	if (right > param->dst_par->width)
+		right = param->dst_par->width;
+
+	bottom = (unsigned int)damage_par->y_offset + damage_par->height;
+	bottom = VSP_ROUND_UP(bottom, 2) * 2;
+	if (bottom > param->dst_par->height)
+		bottom = param->dst_par->height;
+
+	area->x_offset = damage_par->x_offset & ~0x1;
+	area->y_offset = damage_par->y_offset & ~0x1;
+	area->width = (unsigned short)(right - area->x_offset);
+	area->height = (unsigned short)(bottom - area->y_offset);
+
+	/* set output parameter */
+	*dst_par = *param->dst_par;
+	dst_par->x_offset += area->x_offset;
+	dst_par->y_offset += area->y_offset;
+	dst_par->width = area->width;
+	dst_par->height = area->height;
+	dst_par->x_coffset = 0;
+	dst_par->y_coffset = 0;
+
+	*st_par = *param;
+	st_par->dst_par = dst_par;
+	st_par->damage_par = NULL;
+
+	/* damaged area in composition */
+	area->x_offset += param->dst_par->x_coffset;
+	area->y_offset += param->dst_par->y_coffset;
+
+	/* set BRU parameter */
+	if (param->use_module & VSP_BRU_USE) {
+		damage_info->ctrl_par = *param->ctrl_par;
+		damage_info->bru_par = *param->ctrl_par->bru;
+		bru_par = &damage_info->bru_par;
+
+		damage_info->ctrl_par.bru = bru_par;
+		st_par->ctrl_par = &damage_info->ctrl_par;
+
+		if (bru_par->blend_virtual) {
+			damage_info->vir_par = *bru_par->blend_virtual;
+			vir_par = &damage_info->vir_par;
+			bru_par->blend_virtual = vir_par;
+
+			if (vir_par->pwd == VSP_LAYER_PARENT) {
+				vir_par->x_position = 0;
+				vir_par->y_position = 0;
+			}
+
+			if (!vsp_ins_clip_damage_layer(area,
+					&vir_par->x_position,
+					&vir_par->y_position,
+					&vir_par->width,
+					&vir_par->height,
+					&x_skip,
+					&y_skip)) {
+				if (!vsp_ins_drop_damage_layer(
+						bru_par, VSP_LAY_VIRTUAL))
+					return VSP_FALSE;
+			}
+		}
+	}
+
+	/* set input parameter */
+	for (i = 0; i < param->rpf_num; i++) {
+		if (!param->src_par[i])
+			return VSP_FALSE;
+
+		src_par = &damage_info->src_par[src_idx];
+		*src_par = *param->src_par[i];
+
+		if (src_par->width_ex || src_par->height_ex)
+			return VSP_FALSE;
+
+		if (src_par->pwd == VSP_LAYER_PARENT) {
+			src_par->x_position = 0;
+			src_par->y_position = 0;
+		}
+
+		if (!vsp_ins_clip_damage_layer(area,
+				&src_par->x_position,
+				&src_par->y_position,
+				&src_par->width,
+				&src_par->height,
+				&x_skip,
+				&y_skip)) {
+			/* skip input source out of damaged area */
+			if (!bru_par)
+				return VSP_FALSE;
+
+			layer = (src_idx < 4) ? (src_idx + 1) : VSP_LAY_5;
+			if (!vsp_ins_drop_damage_layer(bru_par, layer))
+				return VSP_FALSE;
+
+			st_par->rpf_order =
+				(st_par->rpf_order &
+				 ((0x1UL << (src_idx * 4)) - 1)) |
+				((st_par->rpf_order >> ((src_idx + 1) * 4)) <<
+				 (src_idx * 4));
+			continue;
+		}
+
+		if (src_par->vir == VSP_NO_VIR) {
+			src_par->x_offset += x_skip;
+			src_par->y_offset += y_skip;
+		}
+
+		st_par->src_par[src_idx++] = src_par;
+	}
+
+	st_par->rpf_num = src_idx;
+	for (i = src_idx; i < VSP_RPF_MAX; i++)
+		st_par->src_par[i] = NULL;
+
+	return VSP_TRUE;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_check_damage_parameter
+ * Description:	Check parameter of damaged area composition.
+ * Returns:		0/E_VSP_PARA_OUTPAR/E_VSP_PARA_DAMAGE
+ *	return of vsp_ins_check_start_parameter()
+ ******************************************************************************/
+long vsp_ins_check_damage_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *param)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_damage_info *damage_info = &ch_info->damage_info;
+	struct vsp_damage_t *damage_par = param->damage_par;
+	struct vsp_dst_t *dst_par = param->dst_par;
+
+	/* check pointer */
+	if (!dst_par)
+		return E_VSP_PARA_OUTPAR;
+
+	/* check damaged area */
+	if ((damage_par->width == 0) || (damage_par->height == 0))
+		return E_VSP_PARA_DAMAGE;
+
+	if (((unsigned int)damage_par->x_offset + damage_par->width >
+			dst_par->width) ||
+	    ((unsigned int)damage_par->y_offset + damage_par->height >
+			dst_par->height))
+		return E_VSP_PARA_DAMAGE;
+
+	/* compose damaged area only */
+	if (vsp_ins_crop_damage_parameter(damage_info, param)) {
+		if (!vsp_ins_check_start_parameter(prv, &damage_info->st_par))
+			return 0;
+	}
+
+	/* otherwise, compose whole area */
+	damage_info->st_par = *param;
+	damage_info->st_par.damage_par = NULL;
+
+	return vsp_ins_check_start_parameter(prv, &damage_info->st_par);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_set_fill_pass
+ * Description:	Set parameter of a filled rectangle.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_set_fill_pass(
+	struct vsp_fill_info *fill_info,
+	struct vsp_start_t *param,
+	unsigned char pass)
+{
+	struct vsp_start_t *st_par = &fill_info->st_par;
+	struct vsp_dst_t *dst_par = &fill_info->dst_par;
+	struct vsp_damage_t *rect;
+
+	/* set output parameter */
+	*dst_par = *param->dst_par;
+	dst_par->x_coffset = 0;
+	dst_par->y_coffset = 0;
+
+	if (param->fill_par->rect_num) {
+		rect = &param->fill_par->rect[pass];
+
+		dst_par->x_offset += rect->x_offset;
+		dst_par->y_offset += rect->y_offset;
+		dst_par->width = rect->width;
+		dst_par->height = rect->height;
+	}
+
+	/* virtual input covers output */
+	fill_info->src_par.width = dst_par->width;
+	fill_info->src_par.height = dst_par->height;
+
+	memset(st_par, 0, sizeof(struct vsp_start_t));
+	st_par->rpf_num = 1;
+	st_par->src_par[0] = &fill_info->src_par;
+	st_par->dst_par = dst_par;
+	st_par->dl_par = param->dl_par;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_check_fill_parameter
+ * Description:	Check color fill and 1st rectangle parameter.
+ * Returns:		0/E_VSP_PARA_OUTPAR/E_VSP_PARA_USEMODULE/E_VSP_PARA_FILL
+ *	return of vsp_ins_get_cascade_rpf_order()
+ *	return of vsp_ins_check_start_parameter()
+ ******************************************************************************/
+long vsp_ins_check_fill_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *param)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_fill_info *fill_info = &ch_info->fill_info;
+
+	struct vsp_fill_t *fill_par = param->fill_par;
+	struct vsp_dst_t *dst_par = param->dst_par;
+	struct vsp_src_t *src_par = &fill_info->src_par;
+	struct vsp_alpha_unit_t *alpha_par = &fill_info->alpha_par;
+	struct vsp_damage_t *rect;
+
+	unsigned char i;
+	long ercd;
+
+	/* check pointer */
+	if (!dst_par)
+		return E_VSP_PARA_OUTPAR;
+
+	/* fill color is written to WPF directly */
+	if (param->use_module)
+		return E_VSP_PARA_USEMODULE;
+
+	if (param->stripe_par || param->cascade_par || param->damage_par)
+		return E_VSP_PARA_FILL;
+
+	if (dst_par->rotation != VSP_ROT_OFF)
+		return E_VSP_PARA_FILL;
+
+	/* check rectangles */
+	if (fill_par->rect_num > VSP_FILL_RECT_MAX)
+		return E_VSP_PARA_FILL;
+
+	if (fill_par->rect_num && !fill_par->rect)
+		return E_VSP_PARA_FILL;
+
+	for (i = 0; i < fill_par->rect_num; i++) {
+		rect = &fill_par->rect[i];
+
+		if ((rect->width == 0) || (rect->height == 0))
+			return E_VSP_PARA_FILL;
+
+		if (((unsigned int)rect->x_offset + rect->width >
+				dst_par->width) ||
+		    ((unsigned int)rect->y_offset + rect->height >
+				dst_par->height))
+			return E_VSP_PARA_FILL;
+	}
+
+	fill_info->pass_num =
+		(fill_par->rect_num) ? fill_par->rect_num : 1;
+
+	/* set virtual input of fill color */
+	memset(src_par, 0, sizeof(struct vsp_src_t));
+	if (((dst_par->format & 0x40) == 0x40) ^
+		 (dst_par->csc == VSP_CSC_ON))
+		src_par->format = VSP_IN_YUV444_SEMI_PLANAR;
+	else
+		src_par->format = VSP_IN_ARGB8888;
+	src_par->pwd = VSP_LAYER_PARENT;
+	src_par->vir = VSP_VIR;
+	src_par->vircolor = fill_par->color;
+	src_par->alpha = alpha_par;
+
+	memset(alpha_par, 0, sizeof(struct vsp_alpha_unit_t));
+	alpha_par->asel = VSP_ALPHA_NUM5;
+	alpha_par->afix = (unsigned char)(fill_par->color >> 24);
+
+	/* check 1st rectangle */
+	vsp_ins_set_fill_pass(fill_info, param, 0);
+
+	ercd = vsp_ins_get_cascade_rpf_order(prv, &fill_info->st_par);
+	if (ercd)
+		return ercd;
+
+	return vsp_ins_check_start_parameter(prv, &fill_info->st_par);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_check_fill_pass
+ * Description:	Check parameter of 2nd or later filled rectangle.
+ * Returns:		0/E_VSP_PARA_DL_SIZE
+ *	return of vsp_ins_get_cascade_rpf_order()
+ *	return of vsp_ins_check_start_parameter()
+ ******************************************************************************/
+long vsp_ins_check_fill_pass(
+	struct vsp_prv_data *prv,
+	struct vsp_start_t *param,
+	unsigned char pass)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_fill_info *fill_info = &ch_info->fill_info;
+	struct vsp_start_t *st_par = &fill_info->st_par;
+
+	unsigned int used;
+	long ercd;
+
+	vsp_ins_set_fill_pass(fill_info, param, pass);
+
+	/* display list follows preceding rectangle */
+	used = ch_info->next_dl_addr - param->dl_par.hard_addr;
+	if ((used >> 3) >= param->dl_par.tbl_num)
+		return E_VSP_PARA_DL_SIZE;
+
+	st_par->dl_par.hard_addr += used;
+	st_par->dl_par.virt_addr =
+		(void *)((unsigned long)param->dl_par.virt_addr + used);
+	st_par->dl_par.tbl_num -= (unsigned short)(used >> 3);
+
+	/* assign RPF channel */
+	ercd = vsp_ins_get_cascade_rpf_order(prv, st_par);
+	if (ercd)
+		return ercd;
+
+	return vsp_ins_check_start_parameter(prv, st_par);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_get_downscale_ratio
+ * Description:	Get UDS ratio of a pass and remaining ratio.
+ * Returns:		UDS ratio of the pass.
+ ******************************************************************************/
+static unsigned short vsp_ins_get_downscale_ratio(unsigned long *ratio)
+{
+	unsigned long pass_ratio;
+
+	if (*ratio > VSP_UDS_SCALE_MAX) {
+		/* scale down to the limit */
+		pass_ratio = VSP_UDS_SCALE_MAX;
+	} else if (*ratio > VSP_UDS_SCALE_1_1) {
+		/* scale down as early as possible */
+		pass_ratio = *ratio;
+	} else {
+		/* scale up at last pass */
+		pass_ratio = VSP_UDS_SCALE_1_1;
+	}
+
+	/* remaining ratio of later passes */
+	*ratio = (*ratio / pass_ratio) * VSP_UDS_SCALE_1_1 +
+		((*ratio % pass_ratio) * VSP_UDS_SCALE_1_1) / pass_ratio;
+
+	return (unsigned short)pass_ratio;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_check_downscale_parameter
+ * Description:	Check multi-pass downscale and 1st pass parameter.
+ * Returns:		0/E_VSP_PARA_OUTPAR/E_VSP_PARA_DOWNSCALE
+ *	return of vsp_ins_alloc_cascade_buffer()
+ *	return of vsp_ins_check_downscale_pass()
+ ******************************************************************************/
+long vsp_ins_check_downscale_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *param)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_downscale_info *downscale_info = &ch_info->downscale_info;
+
+	struct vsp_downscale_t *downscale_par = param->downscale_par;
+	struct vsp_src_t *src_par = param->src_par[0];
+	struct vsp_dst_t *mid_par = &downscale_info->dst_par;
+	struct vsp_uds_t *uds_par;
+
+	unsigned long x_ratio = downscale_par->x_ratio;
+	unsigned long y_ratio = downscale_par->y_ratio;
+	unsigned short width;
+	unsigned short height;
+	unsigned long size;
+	unsigned short format;
+	unsigned char pass = 0;
+	long ercd;
+
+	/* check pointer */
+	if (!param->dst_par)
+		return E_VSP_PARA_OUTPAR;
+
+	/* single input is scaled by UDS directly */
+	if (!(param->use_module & VSP_UDS_USE) ||
+	    !param->ctrl_par || !param->ctrl_par->uds)
+		return E_VSP_PARA_DOWNSCALE;
+
+	if ((param->rpf_num != 1) || !src_par ||
+	    (src_par->connect != VSP_UDS_USE))
+		return E_VSP_PARA_DOWNSCALE;
+
+	if (param->stripe_par || param->cascade_par ||
+	    param->damage_par || param->fill_par)
+		return E_VSP_PARA_DOWNSCALE;
+
+	if ((x_ratio < VSP_UDS_SCALE_16_1) || (y_ratio < VSP_UDS_SCALE_16_1))
+		return E_VSP_PARA_DOWNSCALE;
+
+	uds_par = param->ctrl_par->uds;
+
+	/* decide ratio of passes */
+	width = src_par->width;
+	height = src_par->height;
+	while ((x_ratio > VSP_UDS_SCALE_MAX) || (y_ratio > VSP_UDS_SCALE_MAX)) {
+		if (pass + 1 >= VSP_DOWNSCALE_PASS_MAX)
+			return E_VSP_PARA_DOWNSCALE;
+
+		downscale_info->x_ratio[pass] =
+			vsp_ins_get_downscale_ratio(&x_ratio);
+		downscale_info->y_ratio[pass] =
+			vsp_ins_get_downscale_ratio(&y_ratio);
+
+		/* size of intermediate surface */
+		if (uds_par->amd == VSP_AMD) {
+			width = VSP_UDS_SCALE_AMD1(
+				width, downscale_info->x_ratio[pass]);
+			height = VSP_UDS_SCALE_AMD1(
+				height, downscale_info->y_ratio[pass]);
+		} else {
+			width = VSP_UDS_SCALE_AMD0(
+				width, downscale_info->x_ratio[pass]);
+			height = VSP_UDS_SCALE_AMD0(
+				height, downscale_info->y_ratio[pass]);
+		}
+
+		if ((width < 4) || (height < 4))
+			return E_VSP_PARA_DOWNSCALE;
+
+		downscale_info->width[pass] = width;
+		downscale_info->height[pass] = height;
+		pass++;
+	}
+
+	downscale_info->x_ratio[pass] = (unsigned short)x_ratio;
+	downscale_info->y_ratio[pass] = (unsigned short)y_ratio;
+	downscale_info->pass_num = (unsigned char)(pass + 1);
+	downscale_info->mid_size = 0;
+	downscale_info->mid_saved = 0;
+
+	if (downscale_info->pass_num > 1) {
+		/* intermediate surface keeps color space of input */
+		/* fixed alpha is not stored per pixel */
+		if ((src_par->format & 0x40) == 0x40)
+			format = VSP_IN_YUV444_INTERLEAVED;
+		else if (src_par->alpha &&
+			 src_par->alpha->asel == VSP_ALPHA_NUM5)
+			format = VSP_IN_RGB888;
+		else
+			format = VSP_IN_ARGB8888;
+
+		/* each intermediate surface is written once and read once */
+		for (pass = 0; pass + 1 < downscale_info->pass_num; pass++) {
+			size = (unsigned long)downscale_info->height[pass] * 2;
+
+			downscale_info->mid_size += size *
+				vsp_ins_get_bpp_luma(
+					format, downscale_info->width[pass]);
+			downscale_info->mid_saved += size *
+				vsp_ins_get_bpp_luma(VSP_IN_ARGB8888,
+					downscale_info->width[pass]);
+		}
+		downscale_info->mid_saved -= downscale_info->mid_size;
+
+		memset(mid_par, 0, sizeof(struct vsp_dst_t));
+		mid_par->stride = (unsigned short)(VSP_ROUND_UP(
+			vsp_ins_get_bpp_luma(format, downscale_info->width[0]),
+			256) * 256);
+		mid_par->format = format;
+		mid_par->pxa = VSP_PAD_IN;
+		mid_par->rotation = VSP_ROT_OFF;
+
+		/* 1st pass makes the largest surface */
+		downscale_info->surface_size = (unsigned int)mid_par->stride *
+			(unsigned int)downscale_info->height[0];
+
+		if (ch_info->split_num) {
+			/* share intermediate surface with cascade */
+			ercd = vsp_ins_alloc_cascade_buffer(prv, ch_info,
+				(size_t)downscale_info->surface_size *
+				((downscale_info->pass_num > 2) ? 2 : 1));
+			if (ercd)
+				return ercd;
+
+			downscale_info->hard_addr =
+				(unsigned int)ch_info->mid_info.hard_addr;
+		} else {
+			/* estimate builds no surface */
+			downscale_info->hard_addr = 0x80000000;
+		}
+	}
+
+	return vsp_ins_check_downscale_pass(prv, param, 0);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_check_downscale_pass
+ * Description:	Check parameter of a multi-pass downscale pass.
+ * Returns:		0/E_VSP_PARA_DL_SIZE
+ *	return of vsp_ins_get_cascade_rpf_order()
+ *	return of vsp_ins_check_start_parameter()
+ ******************************************************************************/
+long vsp_ins_check_downscale_pass(
+	struct vsp_prv_data *prv,
+	struct vsp_start_t *param,
+	unsigned char pass)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_downscale_info *downscale_info = &ch_info->downscale_info;
+
+	struct vsp_start_t *st_par = &downscale_info->st_par;
+	struct vsp_src_t *src_par = &downscale_info->src_par;
+	struct vsp_dst_t *mid_par = &downscale_info->dst_par;
+	struct vsp_uds_t *uds_par = &downscale_info->uds_par;
+	struct vsp_alpha_unit_t *alpha_par = &downscale_info->alpha_par;
+
+	unsigned char last = (pass + 1 == downscale_info->pass_num);
+	unsigned int used;
+	long ercd;
+
+	/* set input parameter */
+	if (pass == 0) {
+		*src_par = *param->src_par[0];
+
+		/* color space is converted at last pass */
+		if (!last)
+			src_par->csc = VSP_CSC_OFF;
+	} else {
+		/* intermediate surface of preceding pass */
+		memset(src_par, 0, sizeof(struct vsp_src_t));
+		src_par->addr = downscale_info->hard_addr +
+			downscale_info->surface_size * ((pass - 1) % 2);
+		src_par->stride = mid_par->stride;
+		src_par->width = downscale_info->width[pass - 1];
+		src_par->height = downscale_info->height[pass - 1];
+		src_par->format = mid_par->format;
+		src_par->pwd = VSP_LAYER_PARENT;
+		src_par->vir = VSP_NO_VIR;
+		src_par->alpha = alpha_par;
+		src_par->connect = VSP_UDS_USE;
+
+		if (last) {
+			src_par->csc = param->src_par[0]->csc;
+			src_par->iturbt = param->src_par[0]->iturbt;
+			src_par->clrcng = param->src_par[0]->clrcng;
+		}
+
+		memset(alpha_par, 0, sizeof(struct vsp_alpha_unit_t));
+		if (mid_par->format == VSP_IN_ARGB8888) {
+			alpha_par->asel = VSP_ALPHA_NUM1;
+			alpha_par->aext = VSP_AEXT_EXPAN;
+		} else if (mid_par->format == VSP_IN_RGB888) {
+			/* same fixed alpha as requested input */
+			alpha_par->asel = VSP_ALPHA_NUM5;
+			alpha_par->afix = param->src_par[0]->alpha->afix;
+		} else {
+			alpha_par->asel = VSP_ALPHA_NUM5;
+			alpha_par->afix = 0xff;
+		}
+	}
+
+	/* set UDS parameter */
+	*uds_par = *param->ctrl_par->uds;
+	uds_par->x_ratio = downscale_info->x_ratio[pass];
+	uds_par->y_ratio = downscale_info->y_ratio[pass];
+
+	if (!last) {
+		/* RPF -> UDS -> WPF to intermediate surface */
+		uds_par->connect = 0;
+
+		memset(&downscale_info->ctrl_par, 0, sizeof(struct vsp_ctrl_t));
+		downscale_info->ctrl_par.uds = uds_par;
+
+		mid_par->addr = downscale_info->hard_addr +
+			downscale_info->surface_size * (pass % 2);
+		mid_par->width = downscale_info->width[pass];
+		mid_par->height = downscale_info->height[pass];
+
+		memset(st_par, 0, sizeof(struct vsp_start_t));
+		st_par->rpf_num = 1;
+		st_par->use_module = VSP_UDS_USE;
+		st_par->src_par[0] = src_par;
+		st_par->dst_par = mid_par;
+		st_par->ctrl_par = &downscale_info->ctrl_par;
+	} else {
+		/* last pass follows requested modules */
+		downscale_info->ctrl_par = *param->ctrl_par;
+		downscale_info->ctrl_par.uds = uds_par;
+
+		*st_par = *param;
+		st_par->src_par[0] = src_par;
+		st_par->ctrl_par = &downscale_info->ctrl_par;
+		st_par->downscale_par = NULL;
+	}
+
+	if (pass == 0) {
+		/* 1st pass reads requested input */
+		st_par->rpf_order = param->rpf_order;
+		st_par->dl_par = param->dl_par;
+
+		return vsp_ins_check_start_parameter(prv, st_par);
+	}
+
+	/* display list follows preceding pass */
+	used = ch_info->next_dl_addr - param->dl_par.hard_addr;
+	if ((used >> 3) >= param->dl_par.tbl_num)
+		return E_VSP_PARA_DL_SIZE;
+
+	st_par->dl_par = param->dl_par;
+	st_par->dl_par.hard_addr += used;
+	st_par->dl_par.virt_addr =
+		(void *)((unsigned long)param->dl_par.virt_addr + used);
+	st_par->dl_par.tbl_num -= (unsigned short)(used >> 3);
+	st_par->option = param->option & VSP_OPT_TBL_RESIDENT;
+
+	/* assign RPF channel */
+	ercd = vsp_ins_get_cascade_rpf_order(prv, st_par);
+	if (ercd)
+		return ercd;
+
+	return vsp_ins_check_start_parameter(prv, st_par);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_get_image_size
+ * Description:	Get byte size of image.
+ * Returns:		byte size.
+ ******************************************************************************/
+static unsigned long vsp_ins_get_image_size(
+	unsigned short format, unsigned short width, unsigned short height)
+{
+	unsigned long size;
+	unsigned long size_c;
+
+	/* RGB or Y plane */
+	size = (unsigned long)vsp_ins_get_bpp_luma(format, width) *
+		vsp_ins_get_line_luma(format, height);
+
+	/* chroma plane */
+	size_c = (unsigned long)vsp_ins_get_bpp_chroma(format, width) *
+		vsp_ins_get_line_chroma(format, height);
+
+	switch (format & 0xff) {
+	case VSP_IN_YUV444_PLANAR:
+	case VSP_IN_YUV422_PLANAR:
+	case VSP_IN_YUV420_PLANAR:
+		/* Cb and Cr plane */
+		size_c <<= 1;
+		break;
+	default:
+		break;
+	}
+
+	return size + size_c;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_get_estimate
+ * Description:	Get estimate information of checked parameter.
+ * Returns:		void
+ ******************************************************************************/
+void vsp_ins_get_estimate(
+	struct vsp_prv_data *prv,
+	struct vsp_start_t *param,
+	struct vsp_estimate_t *estimate)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_src_t *src_par;
+	struct vsp_dst_t *dst_par = param->dst_par;
+
+	unsigned long read_size = 0;
+	unsigned int part_num;
+	unsigned int i;
+
+	/* partition and display list */
+	part_num = vsp_ins_get_part_num(ch_info);
+	estimate->part_num = part_num;
+	estimate->tbl_num = (unsigned short)vsp_ins_get_dl_tbl_num(
+		part_num * ch_info->stripe_info.num);
+
+	read_size += (unsigned long)estimate->tbl_num << 3;
+
+	/* input image */
+	for (i = 0; i < param->rpf_num; i++) {
+		src_par = param->src_par[i];
+
+		/* virtual input reads no memory */
+		if (src_par->vir == VSP_NO_VIR) {
+			read_size += vsp_ins_get_image_size(
+				src_par->format, src_par->width, src_par->height);
+
+			/* overlapped margin of each partition boundary */
+			if (part_num > 1) {
+				read_size += vsp_ins_get_image_size(
+					src_par->format,
+					(unsigned short)(ch_info->part_info.margin
+						* 2 * (part_num - 1)),
+					src_par->height);
+			}
+
+			/* alpha plane */
+			if (src_par->alpha) {
+				if (src_par->alpha->asel == VSP_ALPHA_NUM2)
+					read_size +=
+						(unsigned long)src_par->width *
+						src_par->height;
+				else if (src_par->alpha->asel == VSP_ALPHA_NUM4)
+					read_size += VSP_ROUND_UP(
+						(unsigned long)src_par->width *
+						src_par->height, 8);
+			}
+		}
+
+		/* colour look up table */
+		if (src_par->format == VSP_IN_RGB_CLUT_DATA ||
+		    src_par->format == VSP_IN_YUV_CLUT_DATA)
+			read_size += (unsigned long)src_par->clut->tbl_num << 3;
+	}
+
+	/* look up table */
+	if (ch_info->reserved_module & VSP_LUT_USE) {
+		read_size +=
+			(unsigned long)param->ctrl_par->lut->lut.tbl_num << 3;
+	}
+
+	/* cubic look up table */
+	if (ch_info->reserved_module & VSP_CLU_USE) {
+		read_size +=
+			(unsigned long)param->ctrl_par->clu->clu.tbl_num << 3;
+	}
+
+	estimate->read_size = read_size;
+
+	/* output image */
+	estimate->write_size = vsp_ins_get_image_size(
+		dst_par->format, dst_par->width, dst_par->height);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_get_bus_mode
+ * Description:	Get bus access mode of the job. Automatic mode selects
+ *	the high mode for large streaming jobs and the low mode for small jobs.
+ * Returns:		VSP_BUS_DEFAULT/VSP_BUS_LOW/VSP_BUS_HIGH
+ ******************************************************************************/
+unsigned char vsp_ins_get_bus_mode(
+	struct vsp_prv_data *prv, struct vsp_start_t *param)
+{
+	struct vsp_src_t *src_par;
+
+	unsigned long read_size = 0;
+	unsigned char mode;
+	unsigned int i;
+
+	/* mode of the job takes precedence over mode of the session */
+	mode = param->bus_mode;
+	if (mode == VSP_BUS_DEFAULT)
+		mode = prv->bdata.session;
+
+	if (mode != VSP_BUS_AUTO)
+		return mode;
+
+	/* input image */
+	for (i = 0; i < param->rpf_num; i++) {
+		src_par = param->src_par[i];
+		if (!src_par || src_par->vir != VSP_NO_VIR)
+			continue;
+
+		read_size += vsp_ins_get_image_size(
+			src_par->format, src_par->width, src_par->height);
+	}
+
+	if (read_size >= VSP_BUS_HIGH_SIZE)
+		return VSP_BUS_HIGH;
+	else if (read_size <= VSP_BUS_LOW_SIZE)
+		return VSP_BUS_LOW;
+
+	return VSP_BUS_DEFAULT;
+}
@@ -60,9 +60,13 @@
 #include <linux/of_device.h>
 #include <linux/interrupt.h>
 #include <linux/io.h>
+#include <linux/dma-mapping.h>
 #include <linux/slab.h>
 #include <linux/delay.h>
 #include <linux/pm_runtime.h>
+#include <linux/reset.h>
+#include <linux/ktime.h>
+#include <linux/workqueue.h>
 
 #include "vspm_public.h"
 #include "vspm_ip_ctrl.h"
@@ -170,6 +174,54 @@ static void dlrewrite32_lut(struct vsp_dl_t *clut, unsigned int reg_offset)
 	}
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_is_tbl_resident
+ * Description:	Check whether the table has been loaded already.
+ * Returns:		VSP_TRUE/VSP_FALSE
+ ******************************************************************************/
+unsigned char vsp_ins_is_tbl_resident(
+	struct vsp_tbl_info *tbl_info, struct vsp_dl_t *tbl)
+{
+	/* generation 0 is never cached */
+	if (tbl->tbl_gen == 0)
+		return VSP_FALSE;
+
+	if (tbl_info->hard_addr != tbl->hard_addr ||
+	    tbl_info->tbl_num != tbl->tbl_num ||
+	    tbl_info->tbl_gen != tbl->tbl_gen)
+		return VSP_FALSE;
+
+	return VSP_TRUE;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_load_tbl
+ * Description:	Update residency information of the table.
+ *	The table is always loaded unless the job has VSP_OPT_TBL_RESIDENT.
+ * Returns:		VSP_TRUE(need to load)/VSP_FALSE(already loaded)
+ ******************************************************************************/
+static unsigned char vsp_ins_load_tbl(
+	struct vsp_prv_data *prv,
+	struct vsp_tbl_info *tbl_info,
+	struct vsp_dl_t *tbl)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+
+	if (ch_info->tbl_resident && vsp_ins_is_tbl_resident(tbl_info, tbl))
+		return VSP_FALSE;
+
+	tbl_info->hard_addr = tbl->hard_addr;
+	tbl_info->tbl_num = tbl->tbl_num;
+	/* table of other jobs is never reused */
+	tbl_info->tbl_gen = ch_info->tbl_resident ? tbl->tbl_gen : 0;
+
+	/* statistics of table upload */
+	prv->sdata.tbl_num++;
+	prv->sdata.tbl_size += ((unsigned long)tbl->tbl_num) << 3;
+
+	return VSP_TRUE;
+}
+
 /******************************************************************************
  * Function:		vsp_ins_set_dl_for_dpr
  * Description:	Set DPR register value to display list.
@@ -262,10 +314,11 @@ static void vsp_ins_set_dl_for_dpr(
  ******************************************************************************/
 static void vsp_ins_set_dl_for_rpf(
 	struct vsp_dl_head_info *head,
-	struct vsp_ch_info *ch_info,
+	struct vsp_prv_data *prv,
 	unsigned char rpf_ch,
 	struct vsp_src_t *param)
 {
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
 	struct vsp_rpf_info *rpf_info = &ch_info->rpf_info[rpf_ch];
 
 	unsigned int reg_offset;
@@ -333,7 +386,9 @@ static void vsp_ins_set_dl_for_rpf(
 	/* lookup table register */
 	if (param->format == VSP_IN_RGB_CLUT_DATA ||
 	    param->format == VSP_IN_YUV_CLUT_DATA) {
-		if (param->clut) {
+		if (param->clut &&
+		    vsp_ins_load_tbl(
+				prv, &prv->tdata.clut[rpf_ch], param->clut)) {
 			dlrewrite32_lut(param->clut, reg_offset);
 
 			/* insert display list */
@@ -534,6 +589,7 @@ static void vsp_ins_set_dl_for_uds(
  ******************************************************************************/
 static void vsp_ins_set_dl_for_lut(
 	struct vsp_dl_head_info *head,
+	struct vsp_prv_data *prv,
 	struct vsp_lut_info *lut_info,
 	struct vsp_lut_t *param)
 {
@@ -545,10 +601,13 @@ static void vsp_ins_set_dl_for_lut(
 	body0 = body;
 
 	/* insert LUT table to display list */
-	head->body_num_minus1++;
-	head->body_info[head->body_num_minus1].addr = param->lut.hard_addr;
-	head->body_info[head->body_num_minus1].size =
-		((unsigned int)param->lut.tbl_num) << 3;
+	if (vsp_ins_load_tbl(prv, &prv->tdata.lut, &param->lut)) {
+		head->body_num_minus1++;
+		head->body_info[head->body_num_minus1].addr =
+			param->lut.hard_addr;
+		head->body_info[head->body_num_minus1].size =
+			((unsigned int)param->lut.tbl_num) << 3;
+	}
 
 	/* control register */
 	dlwrite32(&body, VSP_LUT_CTRL, VSP_LUT_CTRL_EN);
@@ -568,6 +627,7 @@ static void vsp_ins_set_dl_for_lut(
  ******************************************************************************/
 static void vsp_ins_set_dl_for_clu(
 	struct vsp_dl_head_info *head,
+	struct vsp_prv_data *prv,
 	struct vsp_clu_info *clu_info,
 	struct vsp_clu_t *param)
 {
@@ -581,17 +641,20 @@ static void vsp_ins_set_dl_for_clu(
 	/* control register */
 	dlwrite32(&body, VSP_CLU_CTRL, clu_info->val_ctrl);
 
-	/* CLU table register */
-	if (clu_info->val_ctrl & VSP_CLU_CTRL_AAI) {
-		/* automatic address increment mode */
-		dlwrite32(&body, VSP_CLU_TBL_ADDR, 0);
-	}
+	if (vsp_ins_load_tbl(prv, &prv->tdata.clu, &param->clu)) {
+		/* CLU table register */
+		if (clu_info->val_ctrl & VSP_CLU_CTRL_AAI) {
+			/* automatic address increment mode */
+			dlwrite32(&body, VSP_CLU_TBL_ADDR, 0);
+		}
 
-	/* insert CLU table to display list */
-	head->body_num_minus1++;
-	head->body_info[head->body_num_minus1].addr = param->clu.hard_addr;
-	head->body_info[head->body_num_minus1].size =
-		((unsigned int)param->clu.tbl_num) << 3;
+		/* insert CLU table to display list */
+		head->body_num_minus1++;
+		head->body_info[head->body_num_minus1].addr =
+			param->clu.hard_addr;
+		head->body_info[head->body_num_minus1].size =
+			((unsigned int)param->clu.tbl_num) << 3;
+	}
 
 	/* routing register */
 	dlwrite32(&body, VSP_DPR_CLU_ROUTE, clu_info->val_dpr);
@@ -987,13 +1050,19 @@ static void vsp_ins_set_dl_for_module(
 	/* set look up table parameter */
 	if (module & VSP_LUT_USE) {
 		vsp_ins_set_dl_for_lut(
-			head, &ch_info->lut_info, ctrl_param->lut);
+			head,
+			prv,
+			&ch_info->lut_info,
+			ctrl_param->lut);
 	}
 
 	/* set CLU parameter */
 	if (module & VSP_CLU_USE) {
 		vsp_ins_set_dl_for_clu(
-			head, &ch_info->clu_info, ctrl_param->clu);
+			head,
+			prv,
+			&ch_info->clu_info,
+			ctrl_param->clu);
 	}
 
 	/* set hue saturation value transform parameter */
@@ -1041,8 +1110,8 @@ static void vsp_ins_set_part_full(
 {
 	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
 
-	struct vsp_dl_head_info *head =
-		(struct vsp_dl_head_info *)(st_par->dl_par.virt_addr);
+	struct vsp_dl_head_info *head = (struct vsp_dl_head_info *)
+		VSP_DL_HARD_TO_VIRT(ch_info->next_dl_addr);
 
 	unsigned char rpf_ch;
 	unsigned char rpf_lp;
@@ -1051,6 +1120,7 @@ static void vsp_ins_set_part_full(
 
 	/* initialize DL header */
 	memset(head, 0, VSP_DL_HEAD_SIZE);
+	ch_info->head_dl_addr = ch_info->next_dl_addr;
 	ch_info->next_dl_addr += VSP_DL_HEAD_SIZE;
 	head->body_info[0].addr = ch_info->next_dl_addr;
 
@@ -1063,7 +1133,7 @@ static void vsp_ins_set_part_full(
 		rpf_ch = (unsigned char)(rpf_order & 0xf);
 
 		vsp_ins_set_dl_for_rpf(
-			head, ch_info, rpf_ch, st_par->src_par[rpf_lp]);
+			head, prv, rpf_ch, st_par->src_par[rpf_lp]);
 
 		rpf_order >>= 4;
 	}
@@ -1105,6 +1175,7 @@ static void vsp_ins_set_part_diff(
 
 	/* initialize DL header */
 	memset(head, 0, VSP_DL_HEAD_SIZE);
+	ch_info->head_dl_addr = ch_info->next_dl_addr;
 	ch_info->next_dl_addr += VSP_DL_HEAD_SIZE;
 	head->body_info[0].addr = ch_info->next_dl_addr;
 
@@ -1118,7 +1189,7 @@ static void vsp_ins_set_part_diff(
 	VSP_DL_WRITE(VSP_RPF_SRC_BSIZE, rpf_info->val_bsize);
 
 	/* extended read size register */
-	VSP_DL_WRITE(VSP_RPF_SRC_ESIZE, rpf_info->val_bsize);
+	VSP_DL_WRITE(VSP_RPF_SRC_ESIZE, rpf_info->val_esize);
 
 	/* address register */
 	VSP_DL_WRITE(VSP_RPF_SRCM_ADDR_Y, rpf_info->val_addr_y);
@@ -1132,6 +1203,8 @@ static void vsp_ins_set_part_diff(
 
 	/* input size clipping register */
 	VSP_DL_WRITE(VSP_WPF_HSZCLIP, wpf_info->val_hszclip);
+	if (ch_info->stripe_info.num > 1)
+		VSP_DL_WRITE(VSP_WPF_VSZCLIP, wpf_info->val_vszclip);
 
 	/* address register */
 	VSP_DL_WRITE(VSP_WPF_DSTM_ADDR_Y, wpf_info->val_addr_y);
@@ -1313,6 +1386,187 @@ unsigned int vsp_ins_get_line_chroma(
 		return (unsigned int)offset;
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_get_stripe_src_line
+ * Description:	Get source line corresponding to output line.
+ * Returns:		source line(rounded up).
+ ******************************************************************************/
+unsigned int vsp_ins_get_stripe_src_line(
+	struct vsp_ch_info *ch_info,
+	struct vsp_start_t *st_par,
+	unsigned int line,
+	unsigned char *exact)
+{
+	struct vsp_part_info *part_info = &ch_info->part_info;
+
+	struct vsp_sru_t *sru_par = st_par->ctrl_par->sru;
+	struct vsp_uds_t *uds_par = st_par->ctrl_par->uds;
+
+	unsigned int sru_scale = 1;
+
+	if ((ch_info->reserved_module & VSP_SRU_USE) &&
+	    (sru_par->mode == VSP_SRU_MODE2))
+		sru_scale = 2;
+
+	/* SRU connected after UDS */
+	if (part_info->sru_first_flag == 0) {
+		if (line % sru_scale)
+			*exact = VSP_FALSE;
+		line = VSP_ROUND_UP(line, sru_scale);
+	}
+
+	/* UDS */
+	if (ch_info->reserved_module & VSP_UDS_USE) {
+		line *= (unsigned int)uds_par->y_ratio;
+		if (line & 0xfff)
+			*exact = VSP_FALSE;
+		line = VSP_ROUND_UP(line, 4096);
+	}
+
+	/* SRU connected before UDS */
+	if (part_info->sru_first_flag == 1) {
+		if (line % sru_scale)
+			*exact = VSP_FALSE;
+		line = VSP_ROUND_UP(line, sru_scale);
+	}
+
+	return line;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_replace_stripe_module
+ * Description:	Replace vertical parameter of stripe.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_replace_stripe_module(
+	struct vsp_ch_info *ch_info,
+	struct vsp_start_t *st_par,
+	unsigned short idx)
+{
+	struct vsp_stripe_info *stripe_info = &ch_info->stripe_info;
+	struct vsp_part_info *part_info = &ch_info->part_info;
+	struct vsp_rpf_info *rpf_info =
+		&ch_info->rpf_info[ch_info->src_info[0].rpf_ch];
+	struct vsp_uds_info *uds_info = &ch_info->uds_info;
+	struct vsp_wpf_info *wpf_info = &ch_info->wpf_info;
+
+	struct vsp_src_t *src_par = st_par->src_par[0];	/* input source 0 */
+	struct vsp_dst_t *dst_par = st_par->dst_par;
+	struct vsp_sru_t *sru_par = st_par->ctrl_par->sru;
+
+	unsigned int dst_y = (unsigned int)idx * stripe_info->height;
+	unsigned int dst_h = stripe_info->dst_height - dst_y;
+	unsigned int overlap = stripe_info->overlap;
+	unsigned int src_y;
+	unsigned int src_end;
+	unsigned int lines;
+	unsigned int temp;
+	unsigned char exact = VSP_TRUE;
+
+	if (dst_h > stripe_info->height)
+		dst_h = stripe_info->height;
+
+	/* 1st stripe has no overlapped lines */
+	if (overlap > dst_y)
+		overlap = dst_y;
+
+	/* calculate source lines with margin */
+	src_y = vsp_ins_get_stripe_src_line(
+		ch_info, st_par, dst_y - overlap, &exact);
+	if (idx == stripe_info->num - 1) {
+		src_end = (unsigned int)src_par->height;
+	} else {
+		src_end = vsp_ins_get_stripe_src_line(
+			ch_info, st_par, dst_y + dst_h, &exact);
+		src_end += VSP_STRIPE_MARGIN;
+		if (src_end > src_par->height)
+			src_end = (unsigned int)src_par->height;
+	}
+	stripe_info->src_height = (unsigned short)(src_end - src_y);
+
+	/* replace source address */
+	temp = vsp_ins_get_line_luma(src_par->format, src_y);
+	rpf_info->val_addr_y = stripe_info->rpf_addr_y + temp * src_par->stride;
+
+	temp = vsp_ins_get_line_chroma(src_par->format, src_y);
+	temp *= (unsigned int)src_par->stride_c;
+	if (rpf_info->val_addr_c0)
+		rpf_info->val_addr_c0 = stripe_info->rpf_addr_c0 + temp;
+	if (rpf_info->val_addr_c1)
+		rpf_info->val_addr_c1 = stripe_info->rpf_addr_c1 + temp;
+
+	if (rpf_info->val_addr_ai) {
+		rpf_info->val_addr_ai = stripe_info->rpf_addr_ai +
+			src_y * src_par->alpha->stride_a;
+	}
+
+	/* save address for partition */
+	part_info->rpf_addr_y = rpf_info->val_addr_y;
+	part_info->rpf_addr_c0 = rpf_info->val_addr_c0;
+	part_info->rpf_addr_c1 = rpf_info->val_addr_c1;
+	part_info->rpf_addr_ai = rpf_info->val_addr_ai;
+
+	/* replace basic and extended read size */
+	rpf_info->val_bsize &= 0xffff0000;
+	rpf_info->val_bsize |= (unsigned int)stripe_info->src_height;
+	rpf_info->val_esize &= 0xffff0000;
+	rpf_info->val_esize |= (unsigned int)stripe_info->src_height;
+
+	/* replace UDS output size */
+	if (ch_info->reserved_module & VSP_UDS_USE) {
+		lines = overlap + dst_h;
+		if ((ch_info->reserved_module & VSP_SRU_USE) &&
+		    (part_info->sru_first_flag == 0) &&
+		    (sru_par->mode == VSP_SRU_MODE2))
+			lines = VSP_ROUND_UP(lines, 2);
+
+		uds_info->val_clip &= 0xffff0000;
+		uds_info->val_clip |= lines;
+	}
+
+	/* replace vertical clipping */
+	wpf_info->val_vszclip = VSP_WPF_VSZCLIP_VCEN;
+	wpf_info->val_vszclip |= (overlap << 16) | dst_h;
+
+	/* replace destination address */
+	temp = vsp_ins_get_line_luma(dst_par->format, dst_y);
+	wpf_info->val_addr_y = stripe_info->wpf_addr_y + temp * dst_par->stride;
+
+	temp = vsp_ins_get_line_chroma(dst_par->format, dst_y);
+	temp *= (unsigned int)dst_par->stride_c;
+	if (wpf_info->val_addr_c0)
+		wpf_info->val_addr_c0 = stripe_info->wpf_addr_c0 + temp;
+	if (wpf_info->val_addr_c1)
+		wpf_info->val_addr_c1 = stripe_info->wpf_addr_c1 + temp;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_get_part_alpha_unit
+ * Description:	Get number of pixels per byte of alpha plane.
+ * Returns:		1/8
+ ******************************************************************************/
+static unsigned int vsp_ins_get_part_alpha_unit(struct vsp_src_t *src_par)
+{
+	struct vsp_alpha_unit_t *alpha = src_par->alpha;
+	struct vsp_irop_unit_t *irop = alpha->irop;
+
+	/* 1bit alpha plane */
+	if (alpha->asel == VSP_ALPHA_NUM4)
+		return 8;
+
+	/* 1bit mask-alpha generator */
+	if ((alpha->asel == VSP_ALPHA_NUM1) ||
+	    (alpha->asel == VSP_ALPHA_NUM3)) {
+		if (irop) {
+			if ((irop->ref_sel == VSP_MSKEN_ALPHA) &&
+			    (irop->bit_sel == VSP_ALPHA_1BIT))
+				return 8;
+		}
+	}
+
+	return 1;
+}
+
 /******************************************************************************
  * Function:		vsp_ins_replace_part_src_addr
  * Description:	Replace source address of partition.
@@ -1339,8 +1593,9 @@ static void vsp_ins_replace_part_src_addr(
 
 	/* replace alpha plane */
 	if (rpf_info->val_addr_ai) {
-		rpf_info->val_addr_ai =
-			part_info->rpf_addr_ai + (unsigned int)offset;
+		temp = (unsigned int)offset /
+			vsp_ins_get_part_alpha_unit(src_par);
+		rpf_info->val_addr_ai = part_info->rpf_addr_ai + temp;
 	}
 }
 
@@ -1420,9 +1675,20 @@ static void vsp_ins_replace_part_uds_module(
 	struct vsp_sru_t *sru_par = st_par->ctrl_par->sru;
 	struct vsp_uds_t *uds_par = st_par->ctrl_par->uds;
 
+	unsigned int use_module = ch_info->reserved_module;
+
 	unsigned int l_temp = *l_pos;
 	unsigned int r_temp = *r_pos;
 
+	/* SRU before UDS down-scaling follows the UDS procedure */
+	/* the doubled width is adjusted by RPF module */
+	if ((use_module & VSP_UDS_USE) &&
+	    (use_module & VSP_SRU_USE) &&
+	    part_info->sru_first_flag == 1) {
+		if (uds_par->x_ratio > VSP_UDS_SCALE_1_1)
+			use_module &= ~VSP_SRU_USE;
+	}
+
 	/* check SRU module */
 	if ((ch_info->reserved_module & VSP_SRU_USE) &&
 	    part_info->sru_first_flag == 0) {
@@ -1433,8 +1699,8 @@ static void vsp_ins_replace_part_uds_module(
 	}
 
 	/* check UDS module */
-	if (ch_info->reserved_module & VSP_UDS_USE &&
-	    ch_info->reserved_module & VSP_SRU_USE) {
+	if (use_module & VSP_UDS_USE &&
+	    use_module & VSP_SRU_USE) {
 		unsigned int ratio =
 			(unsigned int)uds_par->x_ratio;
 
@@ -1465,7 +1731,7 @@ static void vsp_ins_replace_part_uds_module(
 			uds_info->val_hphase = 0;
 		if (r_temp & 0xfff)
 			uds_info->val_hphase |= (4096 - (r_temp & 0xfff));
-	} else if (ch_info->reserved_module & VSP_UDS_USE) {
+	} else if (use_module & VSP_UDS_USE) {
 		unsigned int ratio =
 			(unsigned int)uds_par->x_ratio;
 		unsigned short mh, fh, alpha, mha;
@@ -1478,17 +1744,10 @@ static void vsp_ins_replace_part_uds_module(
 		unsigned short src_pos0 = 0;
 		unsigned short src_pos1 = 0;
 		unsigned short dst_pos0_pb = 0;
-		struct vsp_dst_t *dst_par = st_par->dst_par;
 		struct vsp_wpf_info *wpf_info = &ch_info->wpf_info;
-		struct vsp_part_info *part_info = &ch_info->part_info;
-		unsigned short width;
+		unsigned short width = part_info->in_width;
 		unsigned short hstp, hedp;
 
-		if (dst_par->rotation <= VSP_ROT_180)
-			width = dst_par->width;
-		else
-			width = dst_par->height;
-
 		/* <procedure1> Calculate temporary src_pos0 position */
 		mh = (ratio & 0xf000) >> 12;
 		fh = (ratio & 0x0fff);
@@ -1545,11 +1804,12 @@ static void vsp_ins_replace_part_uds_module(
 		}
 
 		if (*l_pos) {
-			int gap = part_info->margin - 1;
+			unsigned int gap =
+				(wpf_info->val_hszclip >> 16) & 0xff;
 
 			wpf_info->val_hszclip &= 0xff00ffff;
 			wpf_info->val_hszclip |=
-				((dst_pos0 - dst_pos0_pb + 1 + gap) << 16);
+				((dst_pos0 - dst_pos0_pb + gap) << 16);
 		}
 
 		/* <procedure4> Calculate src_pos0 position from dst_pos0_pb */
@@ -1629,14 +1889,17 @@ static void vsp_ins_replace_part_rpf_module(
 	struct vsp_rpf_info *rpf_info =
 		&ch_info->rpf_info[ch_info->src_info[0].rpf_ch];
 	struct vsp_uds_info *uds_info = &ch_info->uds_info;
+	struct vsp_wpf_info *wpf_info = &ch_info->wpf_info;
 
 	struct vsp_src_t *src_par = st_par->src_par[0]; /* input source 0 */
 	struct vsp_sru_t *sru_par = st_par->ctrl_par->sru;
 
 	unsigned int offset;
 	unsigned int width;
+	unsigned int height;
 
 	unsigned int sru_scale = 1;
+	unsigned int align = 2;
 	unsigned int clip_offset = 0;
 
 	/* calculate source offset and width */
@@ -1649,15 +1912,23 @@ static void vsp_ins_replace_part_rpf_module(
 			sru_scale = 2;
 	}
 
+	/* 1bit alpha plane is read from byte boundary */
+	if (rpf_info->val_addr_ai)
+		align = vsp_ins_get_part_alpha_unit(src_par);
+	if (align < 2)
+		align = 2;
+
 	/* adjust clipping offset */
-	clip_offset = (offset % (2 * sru_scale));
+	clip_offset = (offset % (align * sru_scale));
 
-	/* adjust UDS input clipping area */
 	if (ch_info->reserved_module & VSP_UDS_USE) {
 		/* replace horizontal input clipping register */
 		uds_info->val_hszclip = clip_offset << 16;
 		uds_info->val_hszclip |= (unsigned int)width;
 		uds_info->val_hszclip |= VSP_UDS_HSZCLIP_HCEN;
+	} else {
+		/* add horizontal clipping offset of WPF */
+		wpf_info->val_hszclip += clip_offset << 16;
 	}
 
 	/* calculate source horizontal size */
@@ -1672,9 +1943,15 @@ static void vsp_ins_replace_part_rpf_module(
 		part_info, rpf_info, src_par, (unsigned short)offset);
 
 	/* replace basic and extended read size */
+	/* horizontal extended area is read as part of the partition */
 	rpf_info->val_bsize = width << 16;
-	rpf_info->val_bsize |= (unsigned int)src_par->height;
-	rpf_info->val_esize = rpf_info->val_bsize;
+	rpf_info->val_bsize |= (unsigned int)ch_info->stripe_info.src_height;
+
+	if (src_par->height_ex != 0)
+		height = (unsigned int)src_par->height_ex;
+	else
+		height = (unsigned int)ch_info->stripe_info.src_height;
+	rpf_info->val_esize = (width << 16) | height;
 }
 
 /******************************************************************************
@@ -1694,6 +1971,7 @@ static void vsp_ins_replace_part_connection_module(
 	struct vsp_dst_t *dst_par = st_par->dst_par;
 	unsigned short width;
 
+	unsigned int in_offset;
 	unsigned int l_pos;
 	unsigned int r_pos;
 
@@ -1702,25 +1980,23 @@ static void vsp_ins_replace_part_connection_module(
 	else
 		width = dst_par->height;
 
-	/* calculate partition position with margin */
-	l_pos = (unsigned int)VSP_CLIP0(dst_offset, part_info->margin);
-	if (width > dst_offset + dst_width + part_info->margin) {
-		r_pos = (unsigned int)
-			(dst_offset + dst_width + part_info->margin);
+	/* calculate partition position of WPF input with margin */
+	in_offset = (unsigned int)(dst_offset + part_info->x_coffset);
+	l_pos = (unsigned int)VSP_CLIP0(in_offset, part_info->margin);
+	if (part_info->in_width >
+	    in_offset + dst_width + part_info->margin) {
+		r_pos = in_offset + dst_width + part_info->margin;
 	} else {
-		r_pos = (unsigned int)width;
+		r_pos = (unsigned int)part_info->in_width;
 		dst_width = width - dst_offset;
 	}
 
 	/* replace horizontal clipping size */
 	wpf_info->val_hszclip = VSP_WPF_HSZCLIP_HCEN;
+	wpf_info->val_hszclip |= ((in_offset - l_pos) << 16);
 	wpf_info->val_hszclip |= ((unsigned int)dst_width);
 
 	if (dst_offset != 0) {
-		/* add horizontal clipping offset */
-		wpf_info->val_hszclip |=
-			(((unsigned int)part_info->margin) << 16);
-
 		/* replace destinationaddress */
 		vsp_ins_replace_part_dst_addr(ch_info, dst_par, dst_width);
 	}
@@ -2030,6 +2306,31 @@ static void vsp_ins_replace_part_independent_module(
 	}
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_set_part_dl
+ * Description:	Set display list of a frame.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_set_part_dl(
+	struct vsp_prv_data *prv, struct vsp_start_t *st_par)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_dl_head_info *pre_head;
+
+	if (ch_info->head_dl_addr == 0) {
+		/* 1st frame */
+		vsp_ins_set_part_full(prv, st_par);
+	} else {
+		/* set next frame auto start of previous header */
+		pre_head = (struct vsp_dl_head_info *)
+			VSP_DL_HARD_TO_VIRT(ch_info->head_dl_addr);
+		pre_head->next_frame_ctrl = 1;
+
+		/* 2nd or more frame */
+		vsp_ins_set_part_diff(ch_info, st_par);
+	}
+}
+
 /******************************************************************************
  * Function:		vsp_ins_set_part_parameter
  * Description:	Set partition parameter.
@@ -2042,11 +2343,10 @@ static void vsp_ins_set_part_parameter(
 	struct vsp_part_info *part_info = &ch_info->part_info;
 
 	struct vsp_dst_t *dst_par = st_par->dst_par;
-	struct vsp_dl_head_info *pre_head =
-		(struct vsp_dl_head_info *)st_par->dl_par.virt_addr;
 
 	unsigned short width;
 	unsigned short dst_offset = 0;
+	unsigned int part_idx = 0;
 
 	if (dst_par->rotation <= VSP_ROT_180)
 		width = dst_par->width;
@@ -2070,13 +2370,16 @@ static void vsp_ins_set_part_parameter(
 					ch_info, st_par, 0, dst_offset);
 
 				/* set display list of partition */
-				vsp_ins_set_part_full(prv, st_par);
+				if (part_info->part_first == 0)
+					vsp_ins_set_part_dl(prv, st_par);
+
+				part_idx++;
 			}
 		}
 	}
 
 	/* partition loop */
-	while (width > dst_offset) {
+	while ((width > dst_offset) && (part_idx < part_info->part_end)) {
 		/*
 		 * If number of remaining pixels of horizontal is small,
 		 * it change margin size so as not to be the minimum
@@ -2098,24 +2401,181 @@ static void vsp_ins_set_part_parameter(
 			ch_info, st_par, dst_offset, part_info->div_size);
 
 		/* set display list of partition */
-		if (dst_offset == 0) {
-			/* 1st partition */
-			vsp_ins_set_part_full(prv, st_par);
-		} else {
-			/* set next frame auto start of previous header */
-			pre_head->next_frame_ctrl = 1;
+		if (part_idx >= part_info->part_first)
+			vsp_ins_set_part_dl(prv, st_par);
+
+		/* update offset */
+		dst_offset += part_info->div_size;
+		part_idx++;
+	}
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_set_stripe_parameter
+ * Description:	Set vertical stripe parameter.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_set_stripe_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *st_par)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_stripe_info *stripe_info = &ch_info->stripe_info;
+	struct vsp_part_info *part_info = &ch_info->part_info;
+	struct vsp_dl_head_info *head;
 
-			/* update DL header */
-			pre_head = (struct vsp_dl_head_info *)
-				VSP_DL_HARD_TO_VIRT(ch_info->next_dl_addr);
+	unsigned int end_dl_addr = 0;
+	unsigned short margin = part_info->margin;
+	unsigned short idx;
 
-			/* 2nd or more partition */
-			vsp_ins_set_part_diff(ch_info, st_par);
+	for (idx = 0; idx < stripe_info->num; idx++) {
+		/* replace vertical parameter */
+		vsp_ins_replace_stripe_module(ch_info, st_par, idx);
+
+		if (part_info->div_flag == 0) {
+			/* unnecessary partition */
+			vsp_ins_set_part_dl(prv, st_par);
+		} else {
+			/* necessary partition */
+			vsp_ins_set_part_parameter(prv, st_par);
+			part_info->margin = margin;
 		}
 
-		/* update offset */
-		dst_offset += part_info->div_size;
+		/* interrupt at end of previous stripe */
+		if (end_dl_addr) {
+			head = (struct vsp_dl_head_info *)
+				VSP_DL_HARD_TO_VIRT(end_dl_addr);
+			head->next_frame_ctrl = 3;
+		}
+		end_dl_addr = ch_info->head_dl_addr;
+	}
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_set_cascade_parameter
+ * Description:	Set cascade composition parameter.
+ * Returns:		0
+ *	return of vsp_ins_check_cascade_pass()
+ ******************************************************************************/
+static long vsp_ins_set_cascade_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *st_par)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_cascade_info *cascade_info = &ch_info->cascade_info;
+	struct vsp_dl_head_info *pre_head;
+
+	unsigned int dl_addr;
+	unsigned char pass;
+	long ercd;
+
+	/* set 1st pass */
+	(void)vsp_ins_set_start_parameter(prv, &cascade_info->st_par);
+	dl_addr = ch_info->wpf_info.val_dl_addr;
+
+	for (pass = 1; pass < cascade_info->pass_num; pass++) {
+		/* check next pass */
+		ercd = vsp_ins_check_cascade_pass(prv, st_par, pass);
+		if (ercd)
+			return ercd;
+
+		/* set next frame auto start of preceding pass */
+		pre_head = (struct vsp_dl_head_info *)
+			VSP_DL_HARD_TO_VIRT(ch_info->head_dl_addr);
+		pre_head->next_frame_ctrl = 1;
+
+		/* set next pass */
+		(void)vsp_ins_set_start_parameter(
+			prv, &cascade_info->st_par);
+	}
+
+	/* start from 1st pass */
+	ch_info->wpf_info.val_dl_addr = dl_addr;
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_set_fill_parameter
+ * Description:	Set color fill parameter.
+ * Returns:		0
+ *	return of vsp_ins_check_fill_pass()
+ ******************************************************************************/
+static long vsp_ins_set_fill_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *st_par)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_fill_info *fill_info = &ch_info->fill_info;
+	struct vsp_dl_head_info *pre_head;
+
+	unsigned int dl_addr;
+	unsigned char pass;
+	long ercd;
+
+	/* set 1st rectangle */
+	(void)vsp_ins_set_start_parameter(prv, &fill_info->st_par);
+	dl_addr = ch_info->wpf_info.val_dl_addr;
+
+	for (pass = 1; pass < fill_info->pass_num; pass++) {
+		/* check next rectangle */
+		ercd = vsp_ins_check_fill_pass(prv, st_par, pass);
+		if (ercd)
+			return ercd;
+
+		/* set next frame auto start of preceding rectangle */
+		pre_head = (struct vsp_dl_head_info *)
+			VSP_DL_HARD_TO_VIRT(ch_info->head_dl_addr);
+		pre_head->next_frame_ctrl = 1;
+
+		/* set next rectangle */
+		(void)vsp_ins_set_start_parameter(prv, &fill_info->st_par);
+	}
+
+	/* start from 1st rectangle */
+	ch_info->wpf_info.val_dl_addr = dl_addr;
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_set_downscale_parameter
+ * Description:	Set multi-pass downscale parameter.
+ * Returns:		0
+ *	return of vsp_ins_check_downscale_pass()
+ ******************************************************************************/
+static long vsp_ins_set_downscale_parameter(
+	struct vsp_prv_data *prv, struct vsp_start_t *st_par)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_downscale_info *downscale_info = &ch_info->downscale_info;
+	struct vsp_dl_head_info *pre_head;
+
+	unsigned int dl_addr;
+	unsigned char pass;
+	long ercd;
+
+	/* set 1st pass */
+	(void)vsp_ins_set_start_parameter(prv, &downscale_info->st_par);
+	dl_addr = ch_info->wpf_info.val_dl_addr;
+
+	for (pass = 1; pass < downscale_info->pass_num; pass++) {
+		/* check next pass */
+		ercd = vsp_ins_check_downscale_pass(prv, st_par, pass);
+		if (ercd)
+			return ercd;
+
+		/* set next frame auto start of preceding pass */
+		pre_head = (struct vsp_dl_head_info *)
+			VSP_DL_HARD_TO_VIRT(ch_info->head_dl_addr);
+		pre_head->next_frame_ctrl = 1;
+
+		/* set next pass */
+		(void)vsp_ins_set_start_parameter(
+			prv, &downscale_info->st_par);
 	}
+
+	/* start from 1st pass */
+	ch_info->wpf_info.val_dl_addr = dl_addr;
+
+	return 0;
 }
 
 /******************************************************************************
@@ -2126,8 +2586,7 @@ static void vsp_ins_set_part_parameter(
 static long vsp_ins_get_hgo_register(struct vsp_prv_data *prv)
 {
 	struct vsp_res_data *rdata = &prv->rdata;
-	struct vsp_hgo_info *hgo_info =
-		&prv->ch_info[prv->ridx].hgo_info;
+	struct vsp_hgo_info *hgo_info = &prv->hdata.hgo_info;
 
 	unsigned int *dst;
 
@@ -2137,7 +2596,9 @@ static long vsp_ins_get_hgo_register(struct vsp_prv_data *prv)
 	if (rdata->start_reservation == 1) {
 		/* set HGO read buffer */
 		vsp_write_reg(
-			(unsigned int)prv->ridx, prv->vsp_reg, VSP_HGO_RBUFS);
+			(unsigned int)prv->hdata.rbuf,
+			prv->vsp_reg,
+			VSP_HGO_RBUFS);
 	}
 
 	if (rdata->start_reservation < 2) {
@@ -2190,8 +2651,7 @@ static long vsp_ins_get_hgo_register(struct vsp_prv_data *prv)
 static long vsp_ins_get_hgt_register(struct vsp_prv_data *prv)
 {
 	struct vsp_res_data *rdata = &prv->rdata;
-	struct vsp_hgt_info *hgt_info =
-		&prv->ch_info[prv->ridx].hgt_info;
+	struct vsp_hgt_info *hgt_info = &prv->hdata.hgt_info;
 
 	unsigned int *dst = hgt_info->virt_addr;
 	unsigned int offset = VSP_HGT_HIST_OFFSET;
@@ -2200,7 +2660,9 @@ static long vsp_ins_get_hgt_register(struct vsp_prv_data *prv)
 	if (rdata->start_reservation == 1) {
 		/* set HGT read buffer */
 		vsp_write_reg(
-			(unsigned int)prv->ridx, prv->vsp_reg, VSP_HGT_RBUFS);
+			(unsigned int)prv->hdata.rbuf,
+			prv->vsp_reg,
+			VSP_HGT_RBUFS);
 	}
 
 	if (rdata->start_reservation < 2) {
@@ -2220,9 +2682,10 @@ static long vsp_ins_get_hgt_register(struct vsp_prv_data *prv)
  *	return of vsp_ins_get_hgo_register()
  *	return of vsp_ins_get_hgt_register()
  ******************************************************************************/
-static long vsp_ins_get_module_register(
-	struct vsp_prv_data *prv, unsigned long module)
+static long vsp_ins_get_module_register(struct vsp_prv_data *prv)
 {
+	unsigned long module = prv->hdata.module;
+
 	long ercd;
 
 	/* set histogram generator-one dimension parameter */
@@ -2252,10 +2715,30 @@ long vsp_ins_set_start_parameter(
 {
 	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
 
+	/* color fill */
+	if (param->fill_par)
+		return vsp_ins_set_fill_parameter(prv, param);
+
+	/* cascade composition */
+	if (param->cascade_par)
+		return vsp_ins_set_cascade_parameter(prv, param);
+
+	/* multi-pass downscale */
+	if (param->downscale_par)
+		return vsp_ins_set_downscale_parameter(prv, param);
+
+	/* damaged area composition */
+	if (param->damage_par)
+		param = &ch_info->damage_info.st_par;
+
 	/* set display list write address */
-	ch_info->next_dl_addr = param->dl_par.hard_addr;
+	ch_info->next_dl_addr = ch_info->wpf_info.val_dl_addr;
+	ch_info->head_dl_addr = 0;
 
-	if (ch_info->part_info.div_flag == 0) {
+	if (ch_info->stripe_info.num > 1) {
+		/* vertical stripe */
+		vsp_ins_set_stripe_parameter(prv, param);
+	} else if (ch_info->part_info.div_flag == 0) {
 		/* unnecessary partition */
 		vsp_ins_set_part_full(prv, param);
 	} else {
@@ -2266,6 +2749,65 @@ long vsp_ins_set_start_parameter(
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_set_preempt_parameter
+ * Description:	Set partitions to stop at every boundary for preemption.
+ * Returns:		void
+ ******************************************************************************/
+void vsp_ins_set_preempt_parameter(
+	struct vsp_prv_data *prv,
+	struct vsp_start_t *st_par,
+	unsigned int resume_part)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->widx];
+	struct vsp_part_info *part_info = &ch_info->part_info;
+	struct vsp_preempt_info *preempt_info = &ch_info->preempt_info;
+	struct vsp_dl_head_info *head;
+
+	unsigned int dl_addr;
+	unsigned int i;
+
+	preempt_info->enable = 0;
+	preempt_info->request = 0;
+
+	if (resume_part == VSP_PREEMPT_OFF)
+		return;
+
+	/* only a single chain of partitions is stopped */
+	if (part_info->div_flag == 0 ||
+	    ch_info->stripe_info.num > 1 ||
+	    ch_info->split_num != 1)
+		return;
+
+	if (st_par->fill_par || st_par->cascade_par || st_par->downscale_par)
+		return;
+
+	/* histogram needs all partitions in one frame */
+	if (st_par->use_module & (VSP_HGO_USE | VSP_HGT_USE))
+		return;
+
+	/* next processing may be already reserved */
+	if (prv->rdata.start_reservation != 0)
+		return;
+
+	if (part_info->part_end < part_info->part_first + 2)
+		return;
+
+	/* stop with interrupt at the end of every partition */
+	dl_addr = ch_info->wpf_info.val_dl_addr;
+	for (i = part_info->part_first; i < part_info->part_end; i++) {
+		head = (struct vsp_dl_head_info *)VSP_DL_HARD_TO_VIRT(dl_addr);
+		head->next_frame_ctrl = 2;
+		dl_addr = head->next_head_addr;
+	}
+
+	preempt_info->part_idx = part_info->part_first;
+	preempt_info->part_end = part_info->part_end;
+	preempt_info->head_addr = ch_info->wpf_info.val_dl_addr;
+	preempt_info->dl_par = st_par->dl_par;
+	preempt_info->enable = 1;
+}
+
 /******************************************************************************
  * Function:		vsp_ins_start_processing
  * Description:	Start VSP processing.
@@ -2295,15 +2837,37 @@ void vsp_ins_start_processing(struct vsp_prv_data *prv)
 }
 
 /******************************************************************************
- * Function:		vsp_ins_stop_processing
- * Description:	Forced stop VSP processing.
- * Returns:		0
+ * Function:		vsp_ins_wait_reset
+ * Description:	Wait for the end of reset. The reset completes in
+ *	microseconds without interrupt, so the status is polled at short
+ *	intervals.
+ * Returns:		remaining loop counter/On timeout is 0.
  ******************************************************************************/
-long vsp_ins_stop_processing(struct vsp_prv_data *prv)
+static unsigned int vsp_ins_wait_reset(
+	void __iomem *reg, unsigned int offset, unsigned int busy)
 {
-	unsigned int status;
-	unsigned int loop_cnt;
+	unsigned int loop_cnt = VSP_STATUS_LOOP_CNT;
+
+	while (vsp_read_reg(reg, offset) & busy) {
+		if (--loop_cnt == 0)
+			break;
+
+		/* sleep */
+		usleep_range(VSP_STATUS_LOOP_TIME, VSP_STATUS_LOOP_TIME * 2);
+	}
 
+	return loop_cnt;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_request_stop
+ * Description:	Request forced stop of VSP processing without waiting.
+ *	The reset of several VSPs progresses in parallel, and
+ *	vsp_ins_stop_processing() waits for it later.
+ * Returns:		void
+ ******************************************************************************/
+void vsp_ins_request_stop(struct vsp_prv_data *prv)
+{
 	/* disable interrupt */
 	vsp_write_reg(0, prv->vsp_reg, VSP_WPF0_IRQ_ENB);
 
@@ -2314,67 +2878,66 @@ long vsp_ins_stop_processing(struct vsp_prv_data *prv)
 	vsp_read_reg(prv->vsp_reg, VSP_WPF0_IRQ_STA);
 	vsp_read_reg(prv->vsp_reg, VSP_WPF0_IRQ_STA);
 
-	/* init loop counter */
-	loop_cnt = VSP_STATUS_LOOP_CNT;
-
-	/* read status register of VSP */
-	status = vsp_read_reg(prv->vsp_reg, VSP_STATUS);
-
-	if (status & VSP_STATUS_WPF0) {
-		/* software reset */
+	/* software reset, unless the requested reset completed */
+	if (vsp_read_reg(prv->vsp_reg, VSP_STATUS) & VSP_STATUS_WPF0)
 		vsp_write_reg(VSP_SRESET_WPF0, prv->vsp_reg, VSP_SRESET);
+}
 
-		/* waiting reset process */
-		do {
-			/* sleep */
-			msleep(VSP_STATUS_LOOP_TIME);
+/******************************************************************************
+ * Function:		vsp_ins_stop_processing
+ * Description:	Forced stop VSP processing.
+ * Returns:		0
+ ******************************************************************************/
+long vsp_ins_stop_processing(struct vsp_prv_data *prv)
+{
+	unsigned int loop_cnt;
+	long ercd = R_VSPM_CANCEL;
+
+	/* keep the device active after callbacks of the jobs */
+	pm_runtime_get_noresume(&prv->pdev->dev);
 
-			/* read status register of VSP */
-			status = vsp_read_reg(prv->vsp_reg, VSP_STATUS);
-		} while ((status & VSP_STATUS_WPF0) &&
-			(--loop_cnt > 0));
+	/* request stop */
+	vsp_ins_request_stop(prv);
+
+	/* waiting reset process */
+	loop_cnt = vsp_ins_wait_reset(
+		prv->vsp_reg, VSP_STATUS, VSP_STATUS_WPF0);
+	if (loop_cnt == 0) {
+		APRINT("%s: happen to timeout after reset of VSP!!\n",
+		       __func__);
+		ercd = R_VSPM_DRIVER_ERR;
 	}
 
 	/* disable callback function */
 	prv->ch_info[0].cb_func = NULL;
 	prv->ch_info[1].cb_func = NULL;
 
-	/* callback function */
-	if (loop_cnt != 0) {
-		vsp_ins_cb_function(prv, R_VSPM_CANCEL);
-		vsp_ins_cb_function(prv, R_VSPM_CANCEL);
-	} else {
-		APRINT("%s: happen to timeout after reset of VSP!!\n",
-		       __func__);
-		vsp_ins_cb_function(prv, R_VSPM_DRIVER_ERR);
-		vsp_ins_cb_function(prv, R_VSPM_DRIVER_ERR);
-	}
+	/* loaded tables are unknown after reset */
+	memset(&prv->tdata, 0, sizeof(prv->tdata));
 
-	/* init loop counter */
-	loop_cnt = VSP_STATUS_LOOP_CNT;
+	/* callback function */
+	vsp_ins_cb_function(prv, ercd);
+	vsp_ins_cb_function(prv, ercd);
 
 	/* read status register of FCP */
-	status = vsp_read_reg(prv->fcp_reg, VSP_FCP_STA);
-
-	if (status & VSP_FCP_STA_ACT) {
+	if (vsp_read_reg(prv->fcp_reg, VSP_FCP_STA) & VSP_FCP_STA_ACT) {
 		/* reset */
 		vsp_write_reg(VSP_FCP_RST_SOFTRST, prv->fcp_reg, VSP_FCP_RST);
 
 		/* waiting reset process */
-		do {
-			/* sleep */
-			msleep(VSP_STATUS_LOOP_TIME);
-
-			/* read status register of FCP */
-			status = vsp_read_reg(prv->fcp_reg, VSP_FCP_STA);
-		} while ((status & VSP_FCP_STA_ACT) &&
-			(--loop_cnt > 0));
+		loop_cnt = vsp_ins_wait_reset(
+			prv->fcp_reg, VSP_FCP_STA, VSP_FCP_STA_ACT);
+		if (loop_cnt == 0) {
+			APRINT("%s: happen to timeout after reset of FCP!!\n",
+			       __func__);
+		}
 	}
 
-	if (loop_cnt == 0) {
-		APRINT("%s: happen to timeout after reset of FCP!!\n",
-		       __func__);
-	}
+	/* wait for the interrupt thread of the stopped jobs */
+	if (prv->irq)
+		synchronize_irq(prv->irq->start);
+
+	vsp_ins_idle_clock(prv);
 
 	return 0;
 }
@@ -2382,22 +2945,19 @@ long vsp_ins_stop_processing(struct vsp_prv_data *prv)
 /******************************************************************************
  * Function:		vsp_ins_wait_processing
  * Description:	Waiting VSP processing.
+ *	The waiter is woken by the callback at the end of jobs.
  * Returns:		0
  ******************************************************************************/
 long vsp_ins_wait_processing(struct vsp_prv_data *prv)
 {
-	unsigned int loop_cnt = VSP_STATUS_LOOP_CNT;
-
-	do {
-		/* sleep */
-		msleep(VSP_STATUS_LOOP_TIME);
-
-		if (prv->ch_info[0].status != VSP_STAT_RUN &&
-		    prv->ch_info[1].status != VSP_STAT_RUN)
-			break;
-	} while (--loop_cnt > 0);
-
-	if (loop_cnt == 0) {
+	long ret;
+
+	ret = wait_event_timeout(
+		prv->idle_wq,
+		prv->ch_info[0].status != VSP_STAT_RUN &&
+		prv->ch_info[1].status != VSP_STAT_RUN,
+		msecs_to_jiffies(VSP_WAIT_TIMEOUT));
+	if (ret == 0) {
 		APRINT("%s: happen to timeout!!\n", __func__);
 		vsp_ins_cb_function(prv, R_VSPM_DRIVER_ERR);
 		vsp_ins_cb_function(prv, R_VSPM_DRIVER_ERR);
@@ -2500,9 +3060,85 @@ long vsp_ins_get_vsp_resource(struct vsp_prv_data *prv)
 						    "renesas,#burst_access",
 						    &rdata->burst_access);
 
+	/*
+	 * next partition of the running job is started in hard interrupt
+	 * context. The next job is started by the VSPM thread as before.
+	 */
+	rdata->hard_restart =
+		of_property_read_bool(np, "renesas,hard-irq-restart");
+
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_put_cascade_buffer
+ * Description:	Return intermediate surface to the pool, or free it.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_put_cascade_buffer(
+	struct vsp_prv_data *prv, struct vsp_ch_info *ch_info)
+{
+	struct vsp_mid_info *mid_info = &ch_info->mid_info;
+
+	if (mid_info->buf) {
+		vspm_pool_put(mid_info->buf);
+		mid_info->buf = NULL;
+	} else if (mid_info->virt_addr) {
+		dma_free_coherent(&prv->pdev->dev, mid_info->size,
+			mid_info->virt_addr, mid_info->hard_addr);
+		mid_info->virt_addr = NULL;
+	}
+	mid_info->size = 0;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_alloc_cascade_buffer
+ * Description:	Get intermediate surface from the pool. The surface is
+ *	allocated for the device when the pool is not usable.
+ * Returns:		0/E_VSP_NO_MEM
+ ******************************************************************************/
+long vsp_ins_alloc_cascade_buffer(
+	struct vsp_prv_data *prv, struct vsp_ch_info *ch_info, size_t size)
+{
+	struct vsp_mid_info *mid_info = &ch_info->mid_info;
+
+	/* reuse surface of the channel */
+	if (mid_info->size >= size)
+		return 0;
+
+	/* return smaller surface */
+	vsp_ins_put_cascade_buffer(prv, ch_info);
+
+	/* get surface */
+	mid_info->buf = vspm_pool_get(size);
+	if (mid_info->buf) {
+		mid_info->hard_addr = mid_info->buf->hard_addr;
+		mid_info->size = vspm_pool_get_size(mid_info->buf);
+		return 0;
+	}
+
+	/* allocate surface for the device */
+	mid_info->virt_addr = dma_alloc_coherent(&prv->pdev->dev,
+		size, &mid_info->hard_addr, GFP_KERNEL);
+	if (!mid_info->virt_addr)
+		return E_VSP_NO_MEM;
+
+	mid_info->size = size;
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_free_cascade_buffer
+ * Description:	Release intermediate surface of cascade composition.
+ * Returns:		void
+ ******************************************************************************/
+void vsp_ins_free_cascade_buffer(struct vsp_prv_data *prv)
+{
+	vsp_ins_put_cascade_buffer(prv, &prv->ch_info[0]);
+	vsp_ins_put_cascade_buffer(prv, &prv->ch_info[1]);
+}
+
 /******************************************************************************
  * Function:		vsp_ins_enable_clock
  * Description:	Enable VSP/FCP clock supply.
@@ -2541,6 +3177,36 @@ long vsp_ins_disable_clock(struct vsp_prv_data *prv)
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_write_bac
+ * Description:	Write bus access control register of usable RPFs.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_write_bac(struct vsp_prv_data *prv, unsigned int reg_temp)
+{
+	unsigned int usable_rpf = prv->rdata.usable_rpf;
+
+	if (usable_rpf & VSP_RPF0_USE)
+		vsp_write_reg(reg_temp, prv->vsp_reg,
+			      VSP_RPF0_OFFSET + VSP_RPF_BAC);
+
+	if (usable_rpf & VSP_RPF1_USE)
+		vsp_write_reg(reg_temp, prv->vsp_reg,
+			      VSP_RPF1_OFFSET + VSP_RPF_BAC);
+
+	if (usable_rpf & VSP_RPF2_USE)
+		vsp_write_reg(reg_temp, prv->vsp_reg,
+			      VSP_RPF2_OFFSET + VSP_RPF_BAC);
+
+	if (usable_rpf & VSP_RPF3_USE)
+		vsp_write_reg(reg_temp, prv->vsp_reg,
+			      VSP_RPF3_OFFSET + VSP_RPF_BAC);
+
+	if (usable_rpf & VSP_RPF4_USE)
+		vsp_write_reg(reg_temp, prv->vsp_reg,
+			      VSP_RPF4_OFFSET + VSP_RPF_BAC);
+}
+
 /******************************************************************************
  * Function:		vsp_ins_init_vsp_reg
  * Description:	Initialize VSP hardware.
@@ -2561,27 +3227,12 @@ static long vsp_ins_init_vsp_reg(struct vsp_prv_data *prv)
 		else
 			reg_temp = VSP_RPF_BAC_B256P;
 
-		if (rdata->usable_rpf & VSP_RPF0_USE)
-			vsp_write_reg(reg_temp, prv->vsp_reg,
-				      VSP_RPF0_OFFSET + VSP_RPF_BAC);
-
-		if (rdata->usable_rpf & VSP_RPF1_USE)
-			vsp_write_reg(reg_temp, prv->vsp_reg,
-				      VSP_RPF1_OFFSET + VSP_RPF_BAC);
-
-		if (rdata->usable_rpf & VSP_RPF2_USE)
-			vsp_write_reg(reg_temp, prv->vsp_reg,
-				      VSP_RPF2_OFFSET + VSP_RPF_BAC);
-
-		if (rdata->usable_rpf & VSP_RPF3_USE)
-			vsp_write_reg(reg_temp, prv->vsp_reg,
-				      VSP_RPF3_OFFSET + VSP_RPF_BAC);
-
-		if (rdata->usable_rpf & VSP_RPF4_USE)
-			vsp_write_reg(reg_temp, prv->vsp_reg,
-				      VSP_RPF4_OFFSET + VSP_RPF_BAC);
+		vsp_ins_write_bac(prv, reg_temp);
 	}
 
+	/* bus access mode of device tree */
+	prv->bdata.mode = VSP_BUS_DEFAULT;
+
 	/* initialize DL control register */
 	vsp_write_reg(
 		VSP_DL_CTRL_WAIT |
@@ -2613,6 +3264,143 @@ static long vsp_ins_init_fcp_reg(struct vsp_prv_data *prv)
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_restore_reg
+ * Description:	Restore registers lost while the device was suspended.
+ *	The registers are kept when only the clocks were stopped.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_restore_reg(struct vsp_prv_data *prv)
+{
+	/* check the register written at initialization */
+	if (vsp_read_reg(prv->vsp_reg, VSP_DL_CTRL) ==
+	    (VSP_DL_CTRL_WAIT | VSP_DL_CTRL_RLM0 | VSP_DL_CTRL_DLE))
+		return;
+
+	(void)vsp_ins_init_vsp_reg(prv);
+	(void)vsp_ins_init_fcp_reg(prv);
+
+	/* loaded tables are lost */
+	memset(&prv->tdata, 0, sizeof(prv->tdata));
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_wake_clock
+ * Description:	Wake up VSP/FCP for a job.
+ * Returns:		0/E_VSP_NO_CLK
+ ******************************************************************************/
+long vsp_ins_wake_clock(struct vsp_prv_data *prv)
+{
+	struct device *dev = &prv->pdev->dev;
+
+	int ercd;
+
+	/* wake up device */
+	ercd = pm_runtime_get_sync(dev);
+	if (ercd < 0) {
+		EPRINT("%s: failed to pm_runtime_get_sync!! ercd=%d\n",
+		       __func__, ercd);
+		pm_runtime_put_noidle(dev);
+		return E_VSP_NO_CLK;
+	}
+
+	/* device was resumed */
+	if (ercd == 0)
+		vsp_ins_restore_reg(prv);
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_idle_clock
+ * Description:	Mark VSP/FCP as idle. The device is suspended after
+ *	the autosuspend delay. This can be called from interrupt context.
+ * Returns:		void
+ ******************************************************************************/
+void vsp_ins_idle_clock(struct vsp_prv_data *prv)
+{
+	struct device *dev = &prv->pdev->dev;
+
+	pm_runtime_mark_last_busy(dev);
+	pm_runtime_put_autosuspend(dev);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_reset_reg
+ * Description:	Reset VSP/FCP after hang and initialize registers.
+ *	Software reset is used when the module reset is not defined.
+ * Returns:		0/E_VSP_NO_CLK
+ *	return of vsp_ins_wake_clock()
+ ******************************************************************************/
+long vsp_ins_reset_reg(struct vsp_prv_data *prv)
+{
+	long ercd;
+
+	ercd = vsp_ins_wake_clock(prv);
+	if (ercd)
+		return ercd;
+
+	/* module reset */
+	if (!prv->rstc || reset_control_reset(prv->rstc))
+		vsp_ins_software_reset(prv);
+
+	(void)vsp_ins_init_vsp_reg(prv);
+	(void)vsp_ins_init_fcp_reg(prv);
+
+	/* loaded tables are lost */
+	memset(&prv->tdata, 0, sizeof(prv->tdata));
+
+	vsp_ins_idle_clock(prv);
+
+	return 0;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_set_bus_mode
+ * Description:	Set read outstanding and burst size of the job.
+ *	The setting is kept while a reserved job is running.
+ * Returns:		void
+ ******************************************************************************/
+void vsp_ins_set_bus_mode(struct vsp_prv_data *prv, unsigned char mode)
+{
+	struct vsp_res_data *rdata = &prv->rdata;
+	unsigned int outstanding;
+	unsigned int bac;
+
+	if (mode == prv->bdata.mode)
+		return;
+
+	/* registers cannot be changed while hardware is running */
+	if (prv->ch_info[prv->widx ^ 1].status == VSP_STAT_RUN)
+		return;
+
+	switch (mode) {
+	case VSP_BUS_LOW:
+		outstanding = FCP_MODE_16;
+		bac = VSP_RPF_BAC_B256P;
+		break;
+	case VSP_BUS_HIGH:
+		outstanding = FCP_MODE_64;
+		bac = VSP_RPF_BAC_B512P;
+		break;
+	default:
+		outstanding = rdata->read_outstanding;
+		if (rdata->burst_access == 1)
+			bac = VSP_RPF_BAC_B512P;
+		else
+			bac = VSP_RPF_BAC_B256P;
+		break;
+	}
+
+	vsp_write_reg(outstanding, prv->fcp_reg, VSP_FCP_CFG0);
+
+	/* burst size is changed only when it is enabled by device tree */
+	if (rdata->burst_enable)
+		vsp_ins_write_bac(prv, bac);
+
+	prv->bdata.mode = mode;
+}
+
 /******************************************************************************
  * Function:		vsp_ins_init_reg
  * Description:	Initialize hardware register.
@@ -2691,6 +3479,119 @@ long vsp_ins_quit_reg(struct vsp_prv_data *prv)
 	return 0;
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_copy_hist
+ * Description:	Copy histogram and notify it.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_copy_hist(struct vsp_prv_data *prv)
+{
+	struct vsp_hist_data *hdata = &prv->hdata;
+	struct vsp_hist_slot_t *slot = hdata->slot;
+
+	/* copy histogram */
+	(void)vsp_ins_get_module_register(prv);
+
+	if (slot) {
+		if (prv->rdata.start_reservation >= 2) {
+			/* histogram was written to memory by hardware */
+			if (hdata->module & VSP_HGO_USE)
+				memcpy(slot->hgo, hdata->hgo_info.virt_addr,
+				       sizeof(slot->hgo));
+			if (hdata->module & VSP_HGT_USE)
+				memcpy(slot->hgt, hdata->hgt_info.virt_addr,
+				       sizeof(slot->hgt));
+		}
+
+		/* sequence number is written last */
+		slot->time = hdata->time;
+		smp_wmb();
+		slot->seq = hdata->seq;
+	}
+
+	/* histogram callback function */
+	if (hdata->cb_func)
+		hdata->cb_func(hdata->cb_userdata);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_hist_work
+ * Description:	Copy histogram out of interrupt context.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_hist_work(struct work_struct *work)
+{
+	struct vsp_prv_data *prv =
+		container_of(work, struct vsp_prv_data, hist_work);
+
+	vsp_ins_copy_hist(prv);
+
+	/* release the device kept for the copy */
+	vsp_ins_idle_clock(prv);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_set_hist_function
+ * Description:	Copy histogram of the finished job, or defer the copy when
+ *	the job has a histogram callback.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_set_hist_function(struct vsp_prv_data *prv, long ercd)
+{
+	struct vsp_ch_info *ch_info = &prv->ch_info[prv->ridx];
+	struct vsp_hist_data *hdata = &prv->hdata;
+	struct vsp_hist_ring_t *ring = ch_info->hist_ring;
+
+	unsigned long module =
+		ch_info->reserved_module & (VSP_HGO_USE | VSP_HGT_USE);
+	unsigned int interval = 1;
+
+	if (!module)
+		return;
+
+	if (ring && ring->interval > 1)
+		interval = ring->interval;
+
+	/* skip the frames out of interval */
+	if (ring && (ch_info->hist_seq % interval) != 0)
+		return;
+
+	/* keep histogram information of the job */
+	hdata->module = module;
+	hdata->rbuf = prv->ridx;
+	hdata->hgo_info = ch_info->hgo_info;
+	hdata->hgt_info = ch_info->hgt_info;
+	hdata->cb_func = ch_info->hist_cb_func;
+	hdata->cb_userdata = ch_info->hist_cb_userdata;
+	hdata->slot = NULL;
+
+	if (ring) {
+		/* fill the slot of histogram ring in sequence */
+		hdata->slot = &ring->slot[
+			(ch_info->hist_seq / interval) % ring->slot_num];
+		hdata->seq = ch_info->hist_seq;
+		hdata->time = (unsigned long long)ktime_to_ns(prv->irq_time);
+
+		if (prv->rdata.start_reservation < 2) {
+			/* read registers into the slot */
+			hdata->hgo_info.virt_addr = hdata->slot->hgo;
+			hdata->hgt_info.virt_addr = hdata->slot->hgt;
+		}
+	}
+
+	/* next job can't be reserved before copy */
+	if (hdata->cb_func &&
+	    prv->rdata.start_reservation == 0 &&
+	    ercd == R_VSPM_OK) {
+		/* keep the device active until the copy */
+		pm_runtime_get_noresume(&prv->pdev->dev);
+		schedule_work(&prv->hist_work);
+		return;
+	}
+
+	vsp_ins_copy_hist(prv);
+}
+
 /******************************************************************************
  * Function:		vsp_ins_cb_function
  * Description:	Callback function processing.
@@ -2714,8 +3615,12 @@ void vsp_ins_cb_function(struct vsp_prv_data *prv, long ercd)
 	ch_info = &prv->ch_info[prv->ridx];
 	if (ch_info->status == VSP_STAT_RUN) {
 		/* copy histogram */
-		(void)vsp_ins_get_module_register(
-			prv, ch_info->reserved_module);
+		vsp_ins_set_hist_function(prv, ercd);
+
+		/* intermediate surface is shared through the pool, */
+		/* surface of the device is kept until quit */
+		if (ch_info->mid_info.buf)
+			vsp_ins_put_cascade_buffer(prv, ch_info);
 
 		ch_info->reserved_rpf = 0;
 		ch_info->reserved_module = 0;
@@ -2736,38 +3641,192 @@ void vsp_ins_cb_function(struct vsp_prv_data *prv, long ercd)
 		/* callback function */
 		if (cb_func)
 			cb_func(id, ercd, userdata);
+
+		/* release the device of the job */
+		vsp_ins_idle_clock(prv);
+
+		/* wake up the waiter for the end of jobs */
+		wake_up(&prv->idle_wq);
 	}
 }
 
+/******************************************************************************
+ * Function:		vsp_ins_stripe_function
+ * Description:	Stripe completion processing.
+ * Returns:		VSP_TRUE(remaining stripes are processing)/VSP_FALSE
+ ******************************************************************************/
+static unsigned char vsp_ins_stripe_function(struct vsp_prv_data *prv)
+{
+	struct vsp_stripe_info *stripe_info =
+		&prv->ch_info[prv->ridx].stripe_info;
+
+	unsigned char running = VSP_FALSE;
+	unsigned short line;
+	unsigned short height;
+
+	if (stripe_info->done + 1 < stripe_info->num) {
+		running = VSP_TRUE;
+
+		/* interrupts may be merged unless reserved */
+		if (prv->rdata.start_reservation == 0) {
+			if (!(READ_ONCE(prv->irq_status) & VSP_STATUS_WPF0))
+				running = VSP_FALSE;
+		}
+	}
+
+	/* notify completed stripes */
+	do {
+		line = stripe_info->done * stripe_info->height;
+		height = stripe_info->dst_height - line;
+		if (height > stripe_info->height)
+			height = stripe_info->height;
+
+		if (stripe_info->cb_func)
+			stripe_info->cb_func(
+				line, height, stripe_info->cb_userdata);
+
+		stripe_info->done++;
+	} while (!running && (stripe_info->done < stripe_info->num));
+
+	return running;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_start_next_part
+ * Description:	Start the next partition of preemptible processing.
+ * Returns:		void
+ ******************************************************************************/
+static void vsp_ins_start_next_part(struct vsp_prv_data *prv)
+{
+	struct vsp_preempt_info *preempt_info =
+		&prv->ch_info[prv->ridx].preempt_info;
+	struct vsp_dl_head_info *head;
+
+	head = (struct vsp_dl_head_info *)
+		((unsigned long)preempt_info->dl_par.virt_addr +
+		 (preempt_info->head_addr - preempt_info->dl_par.hard_addr));
+	preempt_info->head_addr = head->next_head_addr;
+
+	vsp_write_reg(preempt_info->head_addr, prv->vsp_reg, VSP_DL_HDR_ADDR0);
+	vsp_write_reg(VSP_CMD_STRCMD, prv->vsp_reg, VSP_WPF0_CMD);
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_preempt_function
+ * Description:	Partition completion processing.
+ * Returns:		VSP_TRUE(partition is restarted or preempted)/VSP_FALSE
+ ******************************************************************************/
+static unsigned char vsp_ins_preempt_function(struct vsp_prv_data *prv)
+{
+	struct vsp_preempt_info *preempt_info =
+		&prv->ch_info[prv->ridx].preempt_info;
+
+	unsigned int latency;
+
+	if (!preempt_info->enable)
+		return VSP_FALSE;
+
+	preempt_info->part_idx++;
+	if (preempt_info->part_idx >= preempt_info->part_end) {
+		preempt_info->enable = 0;
+		return VSP_FALSE;
+	}
+
+	if (preempt_info->request) {
+		/* latency from request to stop */
+		latency = (unsigned int)ktime_us_delta(
+			prv->irq_time, preempt_info->req_time);
+		if (prv->pdata.latency < latency)
+			prv->pdata.latency = latency;
+		prv->pdata.num++;
+
+		/* keep partition to resume */
+		prv->pdata.resume_part = preempt_info->part_idx;
+
+		preempt_info->enable = 0;
+		vsp_ins_cb_function(prv, R_VSPM_PREEMPT);
+		return VSP_TRUE;
+	}
+
+	/* start next partition */
+	vsp_ins_start_next_part(prv);
+
+	return VSP_TRUE;
+}
+
 /******************************************************************************
  * Function:		vsp_ins_ih
- * Description:	Interrupt handler.
- * Returns:		IRQ_HANDLED
+ * Description:	Interrupt handler. Acknowledge the interrupt and leave
+ *	the completion processing to the interrupt thread.
+ * Returns:		IRQ_HANDLED/IRQ_WAKE_THREAD
  ******************************************************************************/
 static irqreturn_t vsp_ins_ih(int irq, void *dev)
 {
 	struct vsp_prv_data *prv = (struct vsp_prv_data *)dev;
 	struct vsp_ch_info *ch_info;
+	struct vsp_preempt_info *preempt_info;
 
 	unsigned int tmp;
 
 	/* check finished channel */
 	ch_info = &prv->ch_info[prv->ridx];
-	if (ch_info->status == VSP_STAT_RUN) {
-		/* read control register */
-		tmp = vsp_read_reg(prv->vsp_reg, VSP_WPF0_IRQ_STA);
+	if (ch_info->status != VSP_STAT_RUN)
+		return IRQ_HANDLED;
+
+	/* read control register */
+	tmp = vsp_read_reg(prv->vsp_reg, VSP_WPF0_IRQ_STA);
+	if ((tmp & VSP_IRQ_FRMEND) != VSP_IRQ_FRMEND)
+		return IRQ_HANDLED;
+
+	/* clear interrupt */
+	vsp_write_reg(0, prv->vsp_reg, VSP_WPF0_IRQ_STA);
+
+	/* dummy read */
+	vsp_read_reg(prv->vsp_reg, VSP_WPF0_IRQ_STA);
+	vsp_read_reg(prv->vsp_reg, VSP_WPF0_IRQ_STA);
+
+	prv->irq_time = ktime_get();
 
-		if ((tmp & VSP_IRQ_FRMEND) == VSP_IRQ_FRMEND) {
-			/* clear interrupt */
-			vsp_write_reg(0, prv->vsp_reg, VSP_WPF0_IRQ_STA);
+	/* status at the interrupt for the thread */
+	WRITE_ONCE(prv->irq_status, vsp_read_reg(prv->vsp_reg, VSP_STATUS));
 
-			/* dummy read */
-			vsp_read_reg(prv->vsp_reg, VSP_WPF0_IRQ_STA);
-			vsp_read_reg(prv->vsp_reg, VSP_WPF0_IRQ_STA);
+	/* start the next partition without waiting for the thread */
+	preempt_info = &ch_info->preempt_info;
+	if (prv->rdata.hard_restart &&
+	    atomic_read(&prv->irq_cnt) == 0 &&
+	    preempt_info->enable &&
+	    !preempt_info->request &&
+	    preempt_info->part_idx + 1 < preempt_info->part_end) {
+		preempt_info->part_idx++;
+		vsp_ins_start_next_part(prv);
+		return IRQ_HANDLED;
+	}
+
+	smp_mb__before_atomic();
+	atomic_inc(&prv->irq_cnt);
+
+	return IRQ_WAKE_THREAD;
+}
+
+/******************************************************************************
+ * Function:		vsp_ins_ih_thread
+ * Description:	Interrupt thread. Complete the partitions, stripes and jobs
+ *	acknowledged by the interrupt handler.
+ * Returns:		IRQ_HANDLED
+ ******************************************************************************/
+static irqreturn_t vsp_ins_ih_thread(int irq, void *dev)
+{
+	struct vsp_prv_data *prv = (struct vsp_prv_data *)dev;
 
-			/* callback function */
+	while (atomic_dec_if_positive(&prv->irq_cnt) >= 0) {
+		/* job may be aborted */
+		if (prv->ch_info[prv->ridx].status != VSP_STAT_RUN)
+			continue;
+
+		/* callback function */
+		if (!vsp_ins_preempt_function(prv) &&
+		    !vsp_ins_stripe_function(prv))
 			vsp_ins_cb_function(prv, R_VSPM_OK);
-		}
 	}
 
 	return IRQ_HANDLED;
@@ -2782,6 +3841,12 @@ long vsp_ins_reg_ih(struct vsp_prv_data *prv)
 {
 	int ercd;
 
+	/* initialize deferred histogram copy */
+	INIT_WORK(&prv->hist_work, vsp_ins_hist_work);
+
+	/* no interrupt is left to the thread */
+	atomic_set(&prv->irq_cnt, 0);
+
 	/* get irq information from platform */
 	prv->irq = platform_get_resource(prv->pdev, IORESOURCE_IRQ, 0);
 	if (!prv->irq) {
@@ -2790,9 +3855,10 @@ long vsp_ins_reg_ih(struct vsp_prv_data *prv)
 	}
 
 	/* registory interrupt handler */
-	ercd = request_irq(
+	ercd = request_threaded_irq(
 		prv->irq->start,
 		vsp_ins_ih,
+		vsp_ins_ih_thread,
 		IRQF_SHARED,
 		dev_name(&prv->pdev->dev),
 		prv);
@@ -2817,6 +3883,9 @@ long vsp_ins_unreg_ih(struct vsp_prv_data *prv)
 	if (prv->irq) {
 		free_irq(prv->irq->start, prv);
 		prv->irq = NULL;
+
+		/* wait for deferred histogram copy */
+		flush_work(&prv->hist_work);
 	}
 
 	return 0;
@@ -78,6 +78,9 @@
 #define FCP_MODE_64				(0x00000000)
 #define FCP_MODE_16				(0x00000002)
 
+/* start without partition preemption */
+#define VSP_PREEMPT_OFF			(0xFFFFFFFF)
+
 /* public structure */
 struct vsp_init_t {
 	unsigned int ip_num;
@@ -85,6 +88,7 @@ struct vsp_init_t {
 
 struct vsp_open_t {
 	struct platform_device *pdev;
+	struct reset_control *rstc;
 };
 
 struct vsp_status_t {
@@ -92,6 +96,15 @@ struct vsp_status_t {
 	unsigned int rpf_bits;
 	unsigned int rpf_clut_bits;
 	unsigned int wpf_rot_bits;
+	unsigned int preempt_num;		/* number of preemptions */
+	unsigned int preempt_latency;	/* maximum latency(usec) */
+	unsigned int resume_part;		/* partition to resume */
+	unsigned long job_num;			/* number of started jobs */
+	unsigned long dl_size;			/* bytes of display lists */
+	unsigned long tbl_num;			/* number of table uploads */
+	unsigned long tbl_size;			/* bytes of table uploads */
+	unsigned long mid_size;			/* bytes of intermediates */
+	unsigned long mid_saved;		/* bytes saved by packing */
 };
 
 /* public functions */
@@ -104,9 +117,44 @@ long vsp_lib_start(
 	void *callback,
 	struct vsp_start_t *param,
 	void *userdata);
+long vsp_lib_start_split(
+	unsigned char ch,
+	void *callback,
+	struct vsp_start_t *param,
+	void *userdata,
+	unsigned char split_idx,
+	unsigned char split_num);
+long vsp_lib_start_preempt(
+	unsigned char ch,
+	void *callback,
+	struct vsp_start_t *param,
+	void *userdata,
+	unsigned char split_idx,
+	unsigned char split_num,
+	unsigned int resume_part);
+long vsp_lib_preempt(unsigned char ch);
+long vsp_lib_set_bus_mode(unsigned char ch, unsigned char mode);
+long vsp_lib_request_abort(unsigned char ch);
 long vsp_lib_abort(unsigned char ch);
+long vsp_lib_recover(unsigned char ch);
 long vsp_lib_get_status(unsigned char ch, struct vsp_status_t *status);
 long vsp_lib_suspend(unsigned char ch);
 long vsp_lib_resume(unsigned char ch);
+long vsp_lib_estimate(
+	unsigned char ch,
+	struct vsp_start_t *param,
+	struct vsp_estimate_t *estimate);
+unsigned int vsp_lib_get_resident_clut_bits(
+	unsigned char ch, struct vsp_dl_t *clut);
+unsigned int vsp_lib_get_resident_tbl_num(
+	unsigned char ch, struct vsp_start_t *param);
+long vsp_lib_get_part_range(
+	struct vsp_start_t *param,
+	unsigned int *min_num,
+	unsigned int *max_num);
+unsigned char vsp_lib_get_split_num(
+	unsigned int part_num, unsigned short tbl_num, unsigned char max_num);
+unsigned int vsp_lib_get_split_tbl_num(
+	unsigned int part_num, unsigned char split_num);
 
 #endif
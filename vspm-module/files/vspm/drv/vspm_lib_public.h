@@ -79,12 +79,23 @@ struct vspm_api_param_forced_cancel {
 	struct vspm_privdata *priv;
 };
 
+/* check idle parameter */
+struct vspm_api_param_check_idle {
+	struct vspm_privdata *priv;
+};
+
 /* complete processing parameter */
 struct vspm_api_param_on_complete {
 	unsigned short module_id;
 	long result;
 };
 
+/* watchdog processing parameter */
+struct vspm_api_param_on_watchdog {
+	unsigned short module_id;
+	unsigned int seq;
+};
+
 /* library functions */
 void vspm_task(void);
 long vspm_lib_entry(
@@ -97,5 +108,11 @@ long vspm_lib_set_mode(
 	struct vspm_privdata *priv, struct vspm_init_t *param);
 long vspm_lib_get_status(
 	struct vspm_privdata *priv, struct vspm_status_t *param);
+long vspm_lib_check_idle(
+	struct vspm_privdata *priv);
+long vspm_lib_estimate(
+	struct vspm_privdata *priv,
+	struct vspm_job_t *ip_par,
+	struct vspm_estimate_t *param);
 
 #endif
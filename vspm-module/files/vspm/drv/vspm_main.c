@@ -62,6 +62,7 @@
 #include <linux/slab.h>
 #include <linux/io.h>
 #include <linux/pm_runtime.h>
+#include <linux/pm_qos.h>
 
 #include "vspm_public.h"
 #include "vspm_ip_ctrl.h"
@@ -106,6 +107,8 @@ long vspm_init_driver(void **handle, struct vspm_init_t *param)
 	}
 
 	priv->pdrv = pdrv;
+	INIT_LIST_HEAD(&priv->import_list);
+	mutex_init(&priv->import_lock);
 
 	if (atomic_add_return(1, &pdrv->counter) == 1) {
 		/* first time open */
@@ -150,6 +153,7 @@ long vspm_quit_driver(void *handle)
 	struct vspm_privdata *priv = (struct vspm_privdata *)handle;
 	struct vspm_drvdata *pdrv = p_vspm_drvdata;
 	int cnt;
+	int i;
 
 	long ercd;
 
@@ -182,6 +186,12 @@ long vspm_quit_driver(void *handle)
 	}
 
 	up(&pdrv->init_sem);
+
+	/* release imported dma-bufs and scratch slots */
+	vspm_release_all(priv);
+	for (i = 0; i < VSPM_SCRATCH_SLOT_NUM; i++)
+		(void)vspm_put_scratch_slot(priv, (unsigned char)i);
+
 	priv->pdrv = NULL;
 	kfree(priv);
 
@@ -291,6 +301,179 @@ long vspm_get_status(void *handle, struct vspm_status_t *status)
 }
 EXPORT_SYMBOL(vspm_get_status);
 
+/******************************************************************************
+ * Function:		vspm_estimate_job
+ * Description:	Estimate the cost of the job without processing it.
+ * Returns:		R_VSPM_OK
+ *	return of vspm_lib_estimate()
+ ******************************************************************************/
+long vspm_estimate_job(
+	void *handle,
+	struct vspm_job_t *ip_param,
+	struct vspm_estimate_t *estimate)
+{
+	struct vspm_privdata *priv = (struct vspm_privdata *)handle;
+	long ercd;
+
+	/* check parameter */
+	if (!priv)
+		return R_VSPM_PARAERR;
+
+	if (priv->pdrv != p_vspm_drvdata)
+		return R_VSPM_PARAERR;
+
+	if (!ip_param || !estimate)
+		return R_VSPM_PARAERR;
+
+	/* estimate job */
+	ercd = vspm_lib_estimate(priv, ip_param, estimate);
+
+	return ercd;
+}
+EXPORT_SYMBOL(vspm_estimate_job);
+
+/******************************************************************************
+ * Function:		vspm_import_buffer
+ * Description:	Import dma-buf and get the address given to jobs.
+ * Returns:		R_VSPM_PARAERR
+ *	return of vspm_import()
+ ******************************************************************************/
+long vspm_import_buffer(
+	void *handle, struct dma_buf *dmabuf, unsigned int *hard_addr)
+{
+	struct vspm_privdata *priv = (struct vspm_privdata *)handle;
+
+	/* check parameter */
+	if (!priv)
+		return R_VSPM_PARAERR;
+
+	if (priv->pdrv != p_vspm_drvdata)
+		return R_VSPM_PARAERR;
+
+	if (!dmabuf || !hard_addr)
+		return R_VSPM_PARAERR;
+
+	return vspm_import(priv, dmabuf, hard_addr);
+}
+EXPORT_SYMBOL(vspm_import_buffer);
+
+/******************************************************************************
+ * Function:		vspm_release_buffer
+ * Description:	Release imported dma-buf.
+ * Returns:		R_VSPM_PARAERR
+ *	return of vspm_release()
+ ******************************************************************************/
+long vspm_release_buffer(void *handle, struct dma_buf *dmabuf)
+{
+	struct vspm_privdata *priv = (struct vspm_privdata *)handle;
+
+	/* check parameter */
+	if (!priv)
+		return R_VSPM_PARAERR;
+
+	if (priv->pdrv != p_vspm_drvdata)
+		return R_VSPM_PARAERR;
+
+	if (!dmabuf)
+		return R_VSPM_PARAERR;
+
+	return vspm_release(priv, dmabuf);
+}
+EXPORT_SYMBOL(vspm_release_buffer);
+
+/******************************************************************************
+ * Function:		vspm_get_scratch
+ * Description:	Get scratch surface bound to the slot of the handle.
+ * Returns:		R_VSPM_PARAERR
+ *	return of vspm_get_scratch_slot()
+ ******************************************************************************/
+long vspm_get_scratch(
+	void *handle,
+	unsigned char slot,
+	unsigned int size,
+	unsigned int *hard_addr)
+{
+	struct vspm_privdata *priv = (struct vspm_privdata *)handle;
+
+	/* check parameter */
+	if (!priv)
+		return R_VSPM_PARAERR;
+
+	if (priv->pdrv != p_vspm_drvdata)
+		return R_VSPM_PARAERR;
+
+	if ((slot >= VSPM_SCRATCH_SLOT_NUM) || (size == 0) || !hard_addr)
+		return R_VSPM_PARAERR;
+
+	return vspm_get_scratch_slot(priv, slot, size, hard_addr);
+}
+EXPORT_SYMBOL(vspm_get_scratch);
+
+/******************************************************************************
+ * Function:		vspm_put_scratch
+ * Description:	Return scratch surface of the slot to the pool.
+ * Returns:		R_VSPM_PARAERR
+ *	return of vspm_put_scratch_slot()
+ ******************************************************************************/
+long vspm_put_scratch(void *handle, unsigned char slot)
+{
+	struct vspm_privdata *priv = (struct vspm_privdata *)handle;
+
+	/* check parameter */
+	if (!priv)
+		return R_VSPM_PARAERR;
+
+	if (priv->pdrv != p_vspm_drvdata)
+		return R_VSPM_PARAERR;
+
+	if (slot >= VSPM_SCRATCH_SLOT_NUM)
+		return R_VSPM_PARAERR;
+
+	return vspm_put_scratch_slot(priv, slot);
+}
+EXPORT_SYMBOL(vspm_put_scratch);
+
+/******************************************************************************
+ * Function:		vspm_set_runtime_pm
+ * Description:	Enable runtime PM of the IP with autosuspend, and expose
+ *	the wake-up latency limit of the device tree.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_set_runtime_pm(struct platform_device *pdev)
+{
+	struct device_node *np = pdev->dev.of_node;
+	unsigned int delay = VSPM_AUTOSUSPEND_DELAY;
+	unsigned int latency;
+
+	/* suspend after idle delay of jobs */
+	of_property_read_u32(np, "renesas,autosuspend-delay-ms", &delay);
+	pm_runtime_set_autosuspend_delay(&pdev->dev, (int)delay);
+	pm_runtime_use_autosuspend(&pdev->dev);
+
+	/* budget of wake-up latency(usec) */
+	if (!of_property_read_u32(np, "renesas,wake-latency-us", &latency)) {
+		if (dev_pm_qos_expose_latency_limit(
+				&pdev->dev, (int)latency))
+			APRINT("Cannot set wake latency!! %s\n",
+			       dev_name(&pdev->dev));
+	}
+
+	pm_suspend_ignore_children(&pdev->dev, true);
+	pm_runtime_enable(&pdev->dev);
+}
+
+/******************************************************************************
+ * Function:		vspm_unset_runtime_pm
+ * Description:	Disable runtime PM of the IP.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_unset_runtime_pm(struct platform_device *pdev)
+{
+	pm_runtime_dont_use_autosuspend(&pdev->dev);
+	pm_runtime_disable(&pdev->dev);
+	dev_pm_qos_hide_latency_limit(&pdev->dev);
+}
+
 static int vspm_vsp_probe(struct platform_device *pdev)
 {
 	struct vspm_drvdata *pdrv = p_vspm_drvdata;
@@ -331,13 +514,23 @@ static int vspm_vsp_probe(struct platform_device *pdev)
 		pdrv->vsp_clks[ch][i] = clk;
 	}
 
+	/* set module reset used to recover from hang */
+	pdrv->vsp_rstc[ch] =
+		devm_reset_control_get_optional_exclusive(&pdev->dev, NULL);
+	if (IS_ERR(pdrv->vsp_rstc[ch])) {
+		APRINT("Cannot get reset!! ch=%d\n", ch);
+		pdrv->vsp_rstc[ch] = NULL;
+	}
+
 	/* set driver data */
 	platform_set_drvdata(pdev, &pdrv->vsp_clks[ch]);
 	pdrv->vsp_pdev[ch] = pdev;
 
+	/* pool buffers are allocated for the device */
+	vspm_pool_set_device(&pdev->dev);
+
 	/* set runtime PM */
-	pm_suspend_ignore_children(&pdev->dev, true);
-	pm_runtime_enable(&pdev->dev);
+	vspm_set_runtime_pm(pdev);
 
 	return 0;
 }
@@ -351,7 +544,10 @@ static int vspm_vsp_remove(struct platform_device *pdev)
 	int ch;
 
 	/* unset runtime PM */
-	pm_runtime_disable(&pdev->dev);
+	vspm_unset_runtime_pm(pdev);
+
+	/* pool buffers are not allocated for the device */
+	vspm_pool_unset_device(&pdev->dev);
 
 	/* get channel */
 	of_property_read_u32(np, "renesas,#ch", &ch);
@@ -363,6 +559,7 @@ static int vspm_vsp_remove(struct platform_device *pdev)
 	/* unset clocks */
 	for (i = 0; i < CLKNUM; i++)
 		pdrv->vsp_clks[ch][i] = NULL;
+	pdrv->vsp_rstc[ch] = NULL;
 
 	return 0;
 }
@@ -407,13 +604,23 @@ static int vspm_fdp_probe(struct platform_device *pdev)
 		pdrv->fdp_clks[ch][i] = clk;
 	}
 
+	/* set module reset used to recover from hang */
+	pdrv->fdp_rstc[ch] =
+		devm_reset_control_get_optional_exclusive(&pdev->dev, NULL);
+	if (IS_ERR(pdrv->fdp_rstc[ch])) {
+		APRINT("Cannot get reset!! ch=%d\n", ch);
+		pdrv->fdp_rstc[ch] = NULL;
+	}
+
 	/* set driver data */
 	platform_set_drvdata(pdev, &pdrv->fdp_clks[ch]);
 	pdrv->fdp_pdev[ch] = pdev;
 
+	/* pool buffers are allocated for the device */
+	vspm_pool_set_device(&pdev->dev);
+
 	/* set runtime PM */
-	pm_suspend_ignore_children(&pdev->dev, true);
-	pm_runtime_enable(&pdev->dev);
+	vspm_set_runtime_pm(pdev);
 
 	return 0;
 }
@@ -427,7 +634,10 @@ static int vspm_fdp_remove(struct platform_device *pdev)
 	int ch;
 
 	/* unset runtime PM */
-	pm_runtime_disable(&pdev->dev);
+	vspm_unset_runtime_pm(pdev);
+
+	/* pool buffers are not allocated for the device */
+	vspm_pool_unset_device(&pdev->dev);
 
 	/* get channel */
 	of_property_read_u32(np, "renesas,#ch", &ch);
@@ -439,6 +649,7 @@ static int vspm_fdp_remove(struct platform_device *pdev)
 	/* unset clocks */
 	for (i = 0; i < CLKNUM; i++)
 		pdrv->fdp_clks[ch][i] = NULL;
+	pdrv->fdp_rstc[ch] = NULL;
 
 	return 0;
 }
@@ -591,9 +802,17 @@ static int __init vspm_module_init(void)
 	}
 	p_vspm_drvdata = pdrv;
 
+	/* initialize intermediate surface pool */
+	if (vspm_pool_init()) {
+		kfree(pdrv);
+		p_vspm_drvdata = NULL;
+		return -ENOMEM;
+	}
+
 	/* register a driver for platform-level devices */
 	ercd = vspm_platform_driver_register();
 	if (ercd) {
+		vspm_pool_quit();
 		kfree(pdrv);
 		p_vspm_drvdata = NULL;
 		return ercd;
@@ -614,6 +833,9 @@ static void __exit vspm_module_exit(void)
 {
 	struct vspm_drvdata *pdrv = p_vspm_drvdata;
 
+	/* release pool before devices */
+	vspm_pool_quit();
+
 	vspm_platform_driver_unregister();
 
 	kfree(pdrv);
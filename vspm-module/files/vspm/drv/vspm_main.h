@@ -61,6 +61,12 @@
 #include <linux/cdev.h>
 #include <linux/fs.h>
 #include <linux/clk.h>
+#include <linux/reset.h>
+#include <linux/list.h>
+#include <linux/mutex.h>
+#include <linux/dma-buf.h>
+#include <linux/shrinker.h>
+#include <linux/spinlock.h>
 
 #define DEVNAME				"vspm"
 #define DEVNUM				1
@@ -72,12 +78,27 @@
 #define FCP_CLK_NAME		"fcp"
 #define CLKNUM				2
 
+/* default delay of runtime PM autosuspend(msec) */
+#define VSPM_AUTOSUSPEND_DELAY	100
+
+/* size classes of intermediate surface pool(64KiB to 128MiB) */
+#define VSPM_POOL_CLASS_SHIFT	16
+#define VSPM_POOL_CLASS_NUM		23
+
+/* scratch slots of a handle */
+#define VSPM_SCRATCH_SLOT_NUM	4
+
+/* maximum number of cached dma-buf mappings per handle */
+#define VSPM_IMPORT_MAX			64
+
 /* vspm driver data structure */
 struct vspm_drvdata {
 	struct platform_device *vsp_pdev[VSPM_VSP_IP_MAX];
 	struct clk *vsp_clks[VSPM_VSP_IP_MAX][CLKNUM];
+	struct reset_control *vsp_rstc[VSPM_VSP_IP_MAX];
 	struct platform_device *fdp_pdev[VSPM_FDP_IP_MAX];
 	struct clk *fdp_clks[VSPM_FDP_IP_MAX][CLKNUM];
+	struct reset_control *fdp_rstc[VSPM_FDP_IP_MAX];
 	struct task_struct *task;
 	atomic_t counter;
 	atomic_t suspend;
@@ -99,13 +120,52 @@ struct vspm_request_res_info {
 	unsigned int ch_bits;		/* request channel bit */
 	unsigned short type;		/* using IP */
 	unsigned short mode;		/* operation mode */
+	unsigned char affinity;		/* reorder jobs for warm VSP state */
+	unsigned char bus_mode;		/* bus access mode of VSP jobs */
+	unsigned char watchdog;		/* detect hang of jobs */
+	unsigned char merge;		/* merge queued copies of VSP jobs */
 	struct vspm_fdp_proc_info fdp_info; /* FDP process information */
 };
 
+/* pool buffer structure */
+struct vspm_pool_buf {
+	struct list_head list;
+	void *virt_addr;
+	dma_addr_t hard_addr;
+	unsigned char cls;			/* size class */
+};
+
+/* intermediate surface pool structure */
+struct vspm_pool_info {
+	struct device *dev;			/* device of the mappings */
+	struct iommu_domain *domain;	/* bus address space of the IPs */
+	bool usable;
+	spinlock_t lock;
+	struct list_head free_list[VSPM_POOL_CLASS_NUM];
+	unsigned long used_size;
+	unsigned long free_size;
+	unsigned long peak_size;
+	unsigned long alloc_num;
+	struct shrinker shrinker;
+};
+
+/* imported dma-buf information structure */
+struct vspm_import_info {
+	struct list_head list;
+	struct dma_buf *dmabuf;		/* key of the cache */
+	struct dma_buf_attachment *attach;
+	struct sg_table *sgt;
+	unsigned int hard_addr;		/* address given to jobs */
+};
+
 /* vspm device file private data structure */
 struct vspm_privdata {
 	struct vspm_drvdata *pdrv;
 	struct vspm_request_res_info request_info;
+	struct list_head import_list;	/* imported dma-bufs */
+	unsigned int import_num;		/* number of the dma-bufs */
+	struct mutex import_lock;	/* imports and scratch slots */
+	struct vspm_pool_buf *scratch[VSPM_SCRATCH_SLOT_NUM];
 };
 
 /* subroutines */
@@ -114,5 +174,28 @@ long vspm_quit(struct vspm_drvdata *pdrv);
 long vspm_suspend(struct vspm_drvdata *pdrv);
 long vspm_resume(struct vspm_drvdata *pdrv);
 long vspm_cancel(struct vspm_privdata *priv);
+long vspm_import(
+	struct vspm_privdata *priv,
+	struct dma_buf *dmabuf,
+	unsigned int *hard_addr);
+long vspm_release(struct vspm_privdata *priv, struct dma_buf *dmabuf);
+void vspm_release_all(struct vspm_privdata *priv);
+long vspm_get_scratch_slot(
+	struct vspm_privdata *priv,
+	unsigned char slot,
+	unsigned int size,
+	unsigned int *hard_addr);
+long vspm_put_scratch_slot(struct vspm_privdata *priv, unsigned char slot);
+
+/* intermediate surface pool */
+long vspm_pool_init(void);
+void vspm_pool_quit(void);
+void vspm_pool_set_device(struct device *dev);
+void vspm_pool_unset_device(struct device *dev);
+struct device *vspm_pool_get_device(void);
+struct vspm_pool_buf *vspm_pool_get(size_t size);
+void vspm_pool_put(struct vspm_pool_buf *buf);
+size_t vspm_pool_get_size(struct vspm_pool_buf *buf);
+void vspm_pool_get_status(struct vspm_pool_status_t *status);
 
 #endif /* __VSPM_MAIN_H__ */
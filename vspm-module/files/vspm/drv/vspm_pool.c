@@ -0,0 +1,374 @@
+/*************************************************************************/ /*
+ * VSPM
+ *
+ * Copyright (C) 2015-2017 Renesas Electronics Corporation
+ *
+ * License        Dual MIT/GPLv2
+ *
+ * The contents of this file are subject to the MIT license as set out below.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * the GNU General Public License Version 2 ("GPL") in which case the provisions
+ * of GPL are applicable instead of those above.
+ *
+ * If you wish to allow use of your version of this file only under the terms of
+ * GPL, and not to allow others to use your version of this file under the terms
+ * of the MIT license, indicate your decision by deleting the provisions above
+ * and replace them with the notice and other provisions required by GPL as set
+ * out in the file called "GPL-COPYING" included in this distribution. If you do
+ * not delete the provisions above, a recipient may use your version of this
+ * file under the terms of either the MIT license or GPL.
+ *
+ * This License is also included in this distribution in the file called
+ * "MIT-COPYING".
+ *
+ * EXCEPT AS OTHERWISE STATED IN A NEGOTIATED AGREEMENT: (A) THE SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT; AND (B) IN NO EVENT SHALL THE AUTHORS
+ * OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+ * IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * GPLv2:
+ * If you wish to use this file under the terms of GPL, following terms are
+ * effective.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */ /*************************************************************************/
+
+#include <linux/dma-mapping.h>
+#include <linux/iommu.h>
+#include <linux/platform_device.h>
+#include <linux/shrinker.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+
+#include "vspm_public.h"
+#include "vspm_ip_ctrl.h"
+#include "vspm_main.h"
+#include "vspm_log.h"
+
+static struct vspm_pool_info g_vspm_pool;
+
+/******************************************************************************
+ * Function:		vspm_pool_class_size
+ * Description:	Get byte size of size class.
+ * Returns:		byte size.
+ ******************************************************************************/
+static size_t vspm_pool_class_size(unsigned char cls)
+{
+	/* two classes in every power of two */
+	if (cls & 0x1)
+		return ((size_t)3 << (VSPM_POOL_CLASS_SHIFT - 1)) << (cls >> 1);
+	else
+		return ((size_t)1 << VSPM_POOL_CLASS_SHIFT) << (cls >> 1);
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_shrink
+ * Description:	Release cached buffers of the pool.
+ * Returns:		number of released pages.
+ ******************************************************************************/
+static unsigned long vspm_pool_shrink(unsigned long nr_pages)
+{
+	struct vspm_pool_info *pool = &g_vspm_pool;
+	struct vspm_pool_buf *buf;
+	unsigned long flags;
+	unsigned long freed = 0;
+	size_t size;
+	int cls;
+
+	/* release larger buffers first */
+	for (cls = VSPM_POOL_CLASS_NUM - 1; cls >= 0; cls--) {
+		size = vspm_pool_class_size((unsigned char)cls);
+
+		while (freed < nr_pages) {
+			spin_lock_irqsave(&pool->lock, flags);
+			if (list_empty(&pool->free_list[cls])) {
+				spin_unlock_irqrestore(&pool->lock, flags);
+				break;
+			}
+			buf = list_first_entry(&pool->free_list[cls],
+				struct vspm_pool_buf, list);
+			list_del(&buf->list);
+			pool->free_size -= size;
+			spin_unlock_irqrestore(&pool->lock, flags);
+
+			dma_free_coherent(
+				pool->dev, size, buf->virt_addr, buf->hard_addr);
+			kfree(buf);
+
+			freed += size >> PAGE_SHIFT;
+		}
+	}
+
+	return freed;
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_count
+ * Description:	Count pages which can be released under memory pressure.
+ * Returns:		number of pages.
+ ******************************************************************************/
+static unsigned long vspm_pool_count(
+	struct shrinker *shrinker, struct shrink_control *sc)
+{
+	return g_vspm_pool.free_size >> PAGE_SHIFT;
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_scan
+ * Description:	Release cached buffers under memory pressure.
+ * Returns:		number of released pages/SHRINK_STOP.
+ ******************************************************************************/
+static unsigned long vspm_pool_scan(
+	struct shrinker *shrinker, struct shrink_control *sc)
+{
+	unsigned long freed;
+
+	freed = vspm_pool_shrink(sc->nr_to_scan);
+	if (freed == 0)
+		return SHRINK_STOP;
+
+	return freed;
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_init
+ * Description:	Initialize pool of intermediate surfaces.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_pool_init(void)
+{
+	struct vspm_pool_info *pool = &g_vspm_pool;
+	int i;
+
+	memset(pool, 0, sizeof(struct vspm_pool_info));
+	spin_lock_init(&pool->lock);
+	for (i = 0; i < VSPM_POOL_CLASS_NUM; i++)
+		INIT_LIST_HEAD(&pool->free_list[i]);
+
+	/* register shrinker */
+	pool->shrinker.count_objects = vspm_pool_count;
+	pool->shrinker.scan_objects = vspm_pool_scan;
+	pool->shrinker.seeks = DEFAULT_SEEKS;
+	if (register_shrinker(&pool->shrinker)) {
+		APRINT("failed to register_shrinker\n");
+		return R_VSPM_NG;
+	}
+
+	return R_VSPM_OK;
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_quit
+ * Description:	Finalize pool of intermediate surfaces.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_pool_quit(void)
+{
+	struct vspm_pool_info *pool = &g_vspm_pool;
+
+	unregister_shrinker(&pool->shrinker);
+
+	/* release all cached buffers */
+	(void)vspm_pool_shrink(ULONG_MAX);
+
+	if (pool->used_size)
+		APRINT("%lu bytes of pool are still used\n", pool->used_size);
+
+	if (pool->dev) {
+		put_device(pool->dev);
+		pool->dev = NULL;
+	}
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_set_device
+ * Description:	Set device which pool buffers are allocated for.
+ *	Buffers are mapped once for the first device and are used by all
+ *	IPs, so all IPs must be in one IOMMU domain. The pool is disabled
+ *	when an IP is found in another domain.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_pool_set_device(struct device *dev)
+{
+	struct vspm_pool_info *pool = &g_vspm_pool;
+	struct iommu_domain *domain = iommu_get_domain_for_dev(dev);
+
+	if (!pool->dev) {
+		/* the device is held for the release of buffers */
+		pool->dev = get_device(dev);
+		pool->domain = domain;
+		pool->usable = true;
+		return;
+	}
+
+	if (domain != pool->domain) {
+		APRINT("%s is not in IOMMU domain of %s, pool is disabled\n",
+		       dev_name(dev), dev_name(pool->dev));
+		pool->usable = false;
+	}
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_unset_device
+ * Description:	Unset device at remove. New buffers are not allocated for
+ *	the removed device, and the buffers in use are released with it at
+ *	vspm_pool_quit().
+ * Returns:		void
+ ******************************************************************************/
+void vspm_pool_unset_device(struct device *dev)
+{
+	struct vspm_pool_info *pool = &g_vspm_pool;
+
+	if (dev != pool->dev)
+		return;
+
+	pool->usable = false;
+	(void)vspm_pool_shrink(ULONG_MAX);
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_get_device
+ * Description:	Get device which all IPs share the bus address space of.
+ * Returns:		device or NULL.
+ ******************************************************************************/
+struct device *vspm_pool_get_device(void)
+{
+	struct vspm_pool_info *pool = &g_vspm_pool;
+
+	if (!pool->usable)
+		return NULL;
+
+	return pool->dev;
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_get
+ * Description:	Get buffer from pool, or allocate it.
+ * Returns:		buffer or NULL.
+ ******************************************************************************/
+struct vspm_pool_buf *vspm_pool_get(size_t size)
+{
+	struct vspm_pool_info *pool = &g_vspm_pool;
+	struct vspm_pool_buf *buf = NULL;
+	unsigned long flags;
+	unsigned char cls = 0;
+
+	if (!pool->usable)
+		return NULL;
+
+	/* find size class */
+	while (vspm_pool_class_size(cls) < size) {
+		if (++cls >= VSPM_POOL_CLASS_NUM)
+			return NULL;
+	}
+
+	/* reuse cached buffer */
+	spin_lock_irqsave(&pool->lock, flags);
+	if (!list_empty(&pool->free_list[cls])) {
+		buf = list_first_entry(&pool->free_list[cls],
+			struct vspm_pool_buf, list);
+		list_del(&buf->list);
+		pool->free_size -= vspm_pool_class_size(cls);
+		pool->used_size += vspm_pool_class_size(cls);
+	}
+	spin_unlock_irqrestore(&pool->lock, flags);
+
+	if (buf)
+		return buf;
+
+	buf = kzalloc(sizeof(*buf), GFP_KERNEL);
+	if (!buf)
+		return NULL;
+
+	/* allocate buffer */
+	buf->cls = cls;
+	buf->virt_addr = dma_alloc_coherent(pool->dev,
+		vspm_pool_class_size(cls), &buf->hard_addr, GFP_KERNEL);
+	if (!buf->virt_addr) {
+		/* retry after releasing cached buffers */
+		(void)vspm_pool_shrink(ULONG_MAX);
+		buf->virt_addr = dma_alloc_coherent(pool->dev,
+			vspm_pool_class_size(cls), &buf->hard_addr, GFP_KERNEL);
+		if (!buf->virt_addr) {
+			kfree(buf);
+			return NULL;
+		}
+	}
+
+	/* update high-water mark */
+	spin_lock_irqsave(&pool->lock, flags);
+	pool->used_size += vspm_pool_class_size(cls);
+	pool->alloc_num++;
+	if (pool->peak_size < pool->used_size + pool->free_size)
+		pool->peak_size = pool->used_size + pool->free_size;
+	spin_unlock_irqrestore(&pool->lock, flags);
+
+	return buf;
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_put
+ * Description:	Return buffer to pool. It can be called in interrupt.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_pool_put(struct vspm_pool_buf *buf)
+{
+	struct vspm_pool_info *pool = &g_vspm_pool;
+	unsigned long flags;
+
+	spin_lock_irqsave(&pool->lock, flags);
+	list_add(&buf->list, &pool->free_list[buf->cls]);
+	pool->used_size -= vspm_pool_class_size(buf->cls);
+	pool->free_size += vspm_pool_class_size(buf->cls);
+	spin_unlock_irqrestore(&pool->lock, flags);
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_get_size
+ * Description:	Get byte size of buffer.
+ * Returns:		byte size.
+ ******************************************************************************/
+size_t vspm_pool_get_size(struct vspm_pool_buf *buf)
+{
+	return vspm_pool_class_size(buf->cls);
+}
+
+/******************************************************************************
+ * Function:		vspm_pool_get_status
+ * Description:	Get usage of pool.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_pool_get_status(struct vspm_pool_status_t *status)
+{
+	struct vspm_pool_info *pool = &g_vspm_pool;
+	unsigned long flags;
+
+	spin_lock_irqsave(&pool->lock, flags);
+	status->used_size = pool->used_size;
+	status->free_size = pool->free_size;
+	status->peak_size = pool->peak_size;
+	status->alloc_num = pool->alloc_num;
+	spin_unlock_irqrestore(&pool->lock, flags);
+}
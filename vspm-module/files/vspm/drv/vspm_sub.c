@@ -56,6 +56,9 @@
  */ /*************************************************************************/
 
 #include <linux/kthread.h>
+#include <linux/dma-buf.h>
+#include <linux/platform_device.h>
+#include <linux/slab.h>
 
 #include "frame.h"
 
@@ -211,3 +214,232 @@ long vspm_cancel(struct vspm_privdata *priv)
 
 	return R_VSPM_OK;
 }
+
+/******************************************************************************
+ * Function:		vspm_free_import
+ * Description:	Unmap and detach imported dma-buf.
+ * Returns:		void
+ ******************************************************************************/
+static void vspm_free_import(struct vspm_import_info *import)
+{
+	dma_buf_unmap_attachment(
+		import->attach, import->sgt, DMA_BIDIRECTIONAL);
+	dma_buf_detach(import->dmabuf, import->attach);
+	dma_buf_put(import->dmabuf);
+	kfree(import);
+}
+
+/******************************************************************************
+ * Function:		vspm_import
+ * Description:	Attach and map dma-buf, or reuse the cached mapping.
+ *	Up to VSPM_IMPORT_MAX mappings are cached until the client releases
+ *	them or closes the handle.
+ * Returns:		R_VSPM_OK/R_VSPM_NG/R_VSPM_PARAERR
+ ******************************************************************************/
+long vspm_import(
+	struct vspm_privdata *priv,
+	struct dma_buf *dmabuf,
+	unsigned int *hard_addr)
+{
+	struct vspm_import_info *import;
+	struct device *dev;
+	dma_addr_t addr;
+	long ercd = R_VSPM_OK;
+
+	mutex_lock(&priv->import_lock);
+
+	/* find cached mapping */
+	list_for_each_entry(import, &priv->import_list, list) {
+		if (import->dmabuf == dmabuf) {
+			*hard_addr = import->hard_addr;
+			goto exit;
+		}
+	}
+
+	/* mappings are released only by the client */
+	if (priv->import_num >= VSPM_IMPORT_MAX) {
+		APRINT("too many imported dma-bufs\n");
+		ercd = R_VSPM_NG;
+		goto exit;
+	}
+
+	/* the mapping is shared by all IPs like pool buffers */
+	dev = vspm_pool_get_device();
+	if (!dev) {
+		ercd = R_VSPM_NG;
+		goto exit;
+	}
+
+	import = kzalloc(sizeof(*import), GFP_KERNEL);
+	if (!import) {
+		APRINT("could not allocate the import information\n");
+		ercd = R_VSPM_NG;
+		goto exit;
+	}
+
+	/* hold dma-buf while it is cached */
+	get_dma_buf(dmabuf);
+	import->dmabuf = dmabuf;
+
+	import->attach = dma_buf_attach(dmabuf, dev);
+	if (IS_ERR(import->attach)) {
+		APRINT("failed to dma_buf_attach\n");
+		ercd = R_VSPM_NG;
+		goto err_exit1;
+	}
+
+	import->sgt = dma_buf_map_attachment(import->attach, DMA_BIDIRECTIONAL);
+	if (IS_ERR(import->sgt)) {
+		APRINT("failed to dma_buf_map_attachment\n");
+		ercd = R_VSPM_NG;
+		goto err_exit2;
+	}
+
+	/* hardware takes one contiguous 32bit area */
+	addr = sg_dma_address(import->sgt->sgl);
+	if ((import->sgt->nents != 1) ||
+	    ((unsigned long long)addr > 0xffffffffULL)) {
+		ercd = R_VSPM_PARAERR;
+		goto err_exit3;
+	}
+
+	import->hard_addr = (unsigned int)addr;
+	list_add(&import->list, &priv->import_list);
+	priv->import_num++;
+	*hard_addr = import->hard_addr;
+
+exit:
+	mutex_unlock(&priv->import_lock);
+	return ercd;
+
+err_exit3:
+	dma_buf_unmap_attachment(
+		import->attach, import->sgt, DMA_BIDIRECTIONAL);
+
+err_exit2:
+	dma_buf_detach(dmabuf, import->attach);
+
+err_exit1:
+	dma_buf_put(dmabuf);
+	kfree(import);
+
+	mutex_unlock(&priv->import_lock);
+	return ercd;
+}
+
+/******************************************************************************
+ * Function:		vspm_release
+ * Description:	Release cached mapping of dma-buf. The mapping is kept
+ *	while the handle has queued or running jobs.
+ * Returns:		R_VSPM_OK/R_VSPM_NG/R_VSPM_PARAERR
+ ******************************************************************************/
+long vspm_release(struct vspm_privdata *priv, struct dma_buf *dmabuf)
+{
+	struct vspm_import_info *import;
+	struct vspm_import_info *next;
+	long ercd = R_VSPM_PARAERR;
+
+	/* jobs may refer to the mapping */
+	if (vspm_lib_check_idle(priv)) {
+		APRINT("jobs of the handle are not completed\n");
+		return R_VSPM_NG;
+	}
+
+	mutex_lock(&priv->import_lock);
+
+	list_for_each_entry_safe(import, next, &priv->import_list, list) {
+		if (import->dmabuf == dmabuf) {
+			list_del(&import->list);
+			vspm_free_import(import);
+			priv->import_num--;
+			ercd = R_VSPM_OK;
+			break;
+		}
+	}
+
+	mutex_unlock(&priv->import_lock);
+
+	return ercd;
+}
+
+/******************************************************************************
+ * Function:		vspm_release_all
+ * Description:	Release all cached mappings of the handle.
+ * Returns:		void
+ ******************************************************************************/
+void vspm_release_all(struct vspm_privdata *priv)
+{
+	struct vspm_import_info *import;
+	struct vspm_import_info *next;
+
+	mutex_lock(&priv->import_lock);
+
+	list_for_each_entry_safe(import, next, &priv->import_list, list) {
+		list_del(&import->list);
+		vspm_free_import(import);
+	}
+	priv->import_num = 0;
+
+	mutex_unlock(&priv->import_lock);
+}
+
+/******************************************************************************
+ * Function:		vspm_get_scratch_slot
+ * Description:	Get scratch surface of the slot. The surface bound to the
+ *	slot is reused while it is large enough. A larger surface is refused
+ *	until the slot is put, since queued jobs may refer to the surface.
+ * Returns:		R_VSPM_OK/R_VSPM_NG
+ ******************************************************************************/
+long vspm_get_scratch_slot(
+	struct vspm_privdata *priv,
+	unsigned char slot,
+	unsigned int size,
+	unsigned int *hard_addr)
+{
+	struct vspm_pool_buf *buf;
+	long ercd = R_VSPM_OK;
+
+	mutex_lock(&priv->import_lock);
+
+	buf = priv->scratch[slot];
+	if (buf && (vspm_pool_get_size(buf) < size)) {
+		APRINT("scratch surface is bound to the slot\n");
+		ercd = R_VSPM_NG;
+		goto exit;
+	}
+
+	if (!buf) {
+		buf = vspm_pool_get(size);
+		if (!buf) {
+			APRINT("could not get scratch surface\n");
+			ercd = R_VSPM_NG;
+			goto exit;
+		}
+		priv->scratch[slot] = buf;
+	}
+
+	*hard_addr = (unsigned int)buf->hard_addr;
+
+exit:
+	mutex_unlock(&priv->import_lock);
+	return ercd;
+}
+
+/******************************************************************************
+ * Function:		vspm_put_scratch_slot
+ * Description:	Return scratch surface of the slot to the pool.
+ * Returns:		R_VSPM_OK
+ ******************************************************************************/
+long vspm_put_scratch_slot(struct vspm_privdata *priv, unsigned char slot)
+{
+	mutex_lock(&priv->import_lock);
+
+	if (priv->scratch[slot]) {
+		vspm_pool_put(priv->scratch[slot]);
+		priv->scratch[slot] = NULL;
+	}
+
+	mutex_unlock(&priv->import_lock);
+
+	return R_VSPM_OK;
+}
@@ -259,6 +259,12 @@
 
 #define E_VSP_PARA_FCNL				(-740)
 
+#define E_VSP_PARA_STRIPE			(-750)
+#define E_VSP_PARA_CASCADE			(-751)
+#define E_VSP_PARA_DAMAGE			(-752)
+#define E_VSP_PARA_FILL				(-753)
+#define E_VSP_PARA_DOWNSCALE		(-754)
+
 /* struct vsp_start_t.use_module */
 #define VSP_SRU_USE		(0x0001) /* super-resolution */
 #define VSP_UDS_USE		(0x0002) /* up down scaler */
@@ -272,6 +278,29 @@
 #define VSP_SHP_USE		(0x0800) /* sharpness */
 #define VSP_BRS_USE		(0x1000) /* blend rop sub */
 
+/* struct vsp_start_t.ext_id */
+/* members after ext_id are used only when it is VSP_START_EXT_ID */
+#define VSP_START_EXT_ID	(0x56535045)
+
+/* struct vsp_start_t.option */
+#define VSP_OPT_SPLIT	(0x0001) /* split partitions to idle VSP */
+#define VSP_OPT_TBL_RESIDENT	(0x0002) /* skip tables loaded by tbl_gen */
+
+/* struct vsp_start_t.bus_mode */
+#define VSP_BUS_DEFAULT	(0x00)	/* setting of device tree */
+#define VSP_BUS_AUTO	(0x01)	/* select by bytes read by the job */
+#define VSP_BUS_LOW		(0x02)	/* 16 outstanding, 256 bytes burst */
+#define VSP_BUS_HIGH	(0x03)	/* 64 outstanding, 512 bytes burst */
+
+/* struct vsp_cascade_t */
+#define VSP_CASCADE_LAYER_MAX	(16)	/* maximum number of upper layers */
+
+/* struct vsp_fill_t */
+#define VSP_FILL_RECT_MAX		(32)	/* maximum number of areas */
+
+/* struct vsp_downscale_t */
+#define VSP_DOWNSCALE_PASS_MAX	(4)		/* maximum number of passes */
+
 /* RPF module parameter */
 /* input format */
 #define VSP_IN_RGB332				(0x0100) /* RGB332 */
@@ -677,6 +706,7 @@ struct vsp_dl_t {
 	void *virt_addr;		/* DL buffer address for CPU */
 	unsigned short tbl_num;	/* table number(max 16383) */
 	void *mem_par;			/* reserved */
+	unsigned int tbl_gen;	/* table generation(VSP_OPT_TBL_RESIDENT) */
 };
 
 struct vsp_irop_unit_t {
@@ -872,6 +902,9 @@ struct vsp_bru_t {
 };
 
 /* BRS parameter */
+/* connect VSP_BRU_USE blends the output as the BRU layer following */
+/* the RPFs connected to BRU. the input color space and the parent */
+/* layer are common to all RPFs, and partition is not available. */
 struct vsp_brs_t {
 	unsigned long lay_order;
 	unsigned char adiv;
@@ -879,7 +912,7 @@ struct vsp_brs_t {
 	struct vsp_bld_vir_t *blend_virtual;
 	struct vsp_bld_ctrl_t *blend_unit_a;
 	struct vsp_bld_ctrl_t *blend_unit_b;
-	unsigned long connect;
+	unsigned long connect;		/* 0(WPF) or VSP_BRU_USE */
 };
 
 /* HGO parameter */
@@ -954,6 +987,61 @@ struct vsp_ctrl_t {
 	struct vsp_shp_t *shp;		/* sharpness */
 };
 
+struct vsp_stripe_t {
+	unsigned short height;		/* output lines of a stripe */
+	void (*cb_func)				/* stripe completion */
+		(unsigned short line, unsigned short height, void *userdata);
+	void *userdata;				/* user data of callback */
+};
+
+struct vsp_hist_slot_t {
+	unsigned int seq;			/* frame sequence number */
+	unsigned long long time;	/* completion time(nsec) */
+	unsigned int hgo[256];		/* HGO histogram */
+	unsigned int hgt[192];		/* HGT histogram */
+};
+
+struct vsp_hist_ring_t {
+	struct vsp_hist_slot_t *slot;	/* slots filled in sequence */
+	unsigned int slot_num;		/* number of slots */
+	unsigned int interval;		/* copy every Nth frame(0: every) */
+	unsigned int frame_cnt;		/* sequence number of next frame */
+};
+
+struct vsp_hist_t {
+	void (*cb_func)(void *userdata);	/* histogram is copied */
+	void *userdata;				/* user data of callback */
+	struct vsp_hist_ring_t *ring;		/* histogram ring of session */
+};
+
+struct vsp_layer_t {
+	struct vsp_src_t *src_par;			/* source parameter */
+	struct vsp_bld_ctrl_t *blend_unit;	/* blend onto lower layers */
+};
+
+struct vsp_cascade_t {
+	unsigned char layer_num;		/* number of upper layers */
+	struct vsp_layer_t *layer;		/* bottom to top */
+};
+
+struct vsp_damage_t {
+	unsigned short x_offset;		/* horizontal offset */
+	unsigned short y_offset;		/* vertical offset */
+	unsigned short width;			/* width of damaged area */
+	unsigned short height;			/* height of damaged area */
+};
+
+struct vsp_fill_t {
+	unsigned long color;			/* ARGB or AYUV of WPF input */
+	unsigned char rect_num;			/* number of rectangles */
+	struct vsp_damage_t *rect;		/* filled areas of output */
+};
+
+struct vsp_downscale_t {
+	unsigned long x_ratio;			/* horizontal ratio */
+	unsigned long y_ratio;			/* vertical ratio */
+};
+
 struct vsp_start_t {
 	unsigned char rpf_num;			/* RPF number */
 	unsigned long rpf_order;		/* RPF order */
@@ -962,5 +1050,21 @@ struct vsp_start_t {
 	struct vsp_dst_t *dst_par;		/* destination parameter */
 	struct vsp_ctrl_t *ctrl_par;	/* module parameter */
 	struct vsp_dl_t dl_par;			/* work memory for DL */
+	unsigned int ext_id;			/* VSP_START_EXT_ID */
+	unsigned long option;			/* processing option */
+	struct vsp_stripe_t *stripe_par;	/* vertical stripe parameter */
+	struct vsp_cascade_t *cascade_par;	/* cascade composition */
+	struct vsp_damage_t *damage_par;	/* damaged area of output */
+	struct vsp_fill_t *fill_par;		/* color fill */
+	struct vsp_downscale_t *downscale_par;	/* multi-pass downscale */
+	struct vsp_hist_t *hist_par;		/* deferred histogram copy */
+	unsigned char bus_mode;			/* bus access mode */
+};
+
+struct vsp_estimate_t {
+	unsigned int part_num;			/* partition number */
+	unsigned short tbl_num;			/* required table number for DL */
+	unsigned long read_size;		/* estimated bytes read */
+	unsigned long write_size;		/* estimated bytes written */
 };
 #endif
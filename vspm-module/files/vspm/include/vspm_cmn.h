@@ -67,6 +67,7 @@
 #define R_VSPM_CANCEL		(-5)	/* processing was canceled */
 #define R_VSPM_ALREADY_USED	(-6)	/* already used all channel */
 #define R_VSPM_OCCUPY_CH	(-7)	/* occupy channel */
+#define R_VSPM_PREEMPT		(-8)	/* processing was preempted */
 #define R_VSPM_DRIVER_ERR	(-10)	/* IP error(in driver) */
 
 /* using channel */
@@ -113,12 +114,21 @@ enum {
 #define FCP_TL_DISABLE			(0)
 #define FCP_TL_ENABLE			(1)
 
+/* members after ext_id are used only when it is VSPM_INIT_EXT_ID */
+#define VSPM_INIT_EXT_ID		(0x5653504d)
+
 struct vspm_init_vsp_t {
-	/* reserved */
+	unsigned int ext_id;	/* VSPM_INIT_EXT_ID */
+	unsigned char affinity;	/* prefer IP with similar previous job */
+	unsigned char bus_mode;	/* bus access mode of jobs */
+	unsigned char watchdog;	/* detect hang of jobs by duration */
+	unsigned char merge;	/* merge copies to the same surface */
 };
 
 struct vspm_init_fdp_t {
 	unsigned int hard_addr[2];
+	unsigned int ext_id;	/* VSPM_INIT_EXT_ID */
+	unsigned char watchdog;	/* detect hang of jobs by duration */
 };
 
 /* initialize parameter structure */
@@ -139,11 +149,37 @@ struct vspm_job_t {
 		struct vsp_start_t *vsp;
 		struct fdp_start_t *fdp;
 	} par;
+	/* expected processing time(msec), used only with watchdog */
+	unsigned int duration;
+};
+
+/* usage of intermediate surface pool */
+struct vspm_pool_status_t {
+	unsigned long used_size;	/* bytes used by jobs and clients */
+	unsigned long free_size;	/* bytes cached for reuse */
+	unsigned long peak_size;	/* high-water mark of pool bytes */
+	unsigned long alloc_num;	/* number of allocations */
+};
+
+/* statistics of recovery from IP hang */
+struct vspm_recover_status_t {
+	unsigned long timeout_num;	/* number of timed out jobs */
+	unsigned long retry_num;	/* number of retried jobs */
+	unsigned long error_num;	/* number of jobs failed by timeout */
+	unsigned long latency;		/* max recovery time(usec) */
 };
 
 /* status parameter structure */
 struct vspm_status_t {
 	struct fdp_status_t *fdp;
+	struct vspm_pool_status_t *pool;
+	struct vspm_recover_status_t *recover;
+};
+
+/* estimate parameter structure */
+struct vspm_estimate_t {
+	unsigned int use_ch;
+	struct vsp_estimate_t *vsp;
 };
 
 /* FCP information structure */
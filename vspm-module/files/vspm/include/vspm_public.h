@@ -62,6 +62,8 @@
 #include "fdp_drv.h"
 #include "vspm_cmn.h"
 
+struct dma_buf;
+
 /* callback function */
 typedef void (*PFN_VSPM_COMPLETE_CALLBACK)(
 	unsigned long job_id, long result, void *user_data);
@@ -90,4 +92,33 @@ long vspm_get_status(
 	void *handle,
 	struct vspm_status_t *status);
 
+long vspm_estimate_job(
+	void *handle,
+	struct vspm_job_t *ip_param,
+	struct vspm_estimate_t *estimate);
+
+long vspm_import_buffer(
+	void *handle,
+	struct dma_buf *dmabuf,
+	unsigned int *hard_addr);
+
+/* the mapping is released at once. In mutual mode, R_VSPM_NG is */
+/* returned while the handle has queued or running jobs. In occupy */
+/* mode, release the buffer after the callback of the job */
+long vspm_release_buffer(
+	void *handle,
+	struct dma_buf *dmabuf);
+
+/* the surface of a bound slot is not regrown, put the slot first */
+/* after the jobs referring to the surface are completed */
+long vspm_get_scratch(
+	void *handle,
+	unsigned char slot,
+	unsigned int size,
+	unsigned int *hard_addr);
+
+long vspm_put_scratch(
+	void *handle,
+	unsigned char slot);
+
 #endif	/* __VSPM_PUBLIC_H__ */